@@ -0,0 +1,19 @@
+#include "AllocHooks.h"
+
+thread_local AllocThreadState t_allocState;
+
+AllocStats threadAllocStats()
+{
+    return AllocStats{t_allocState.calls, t_allocState.bytes};
+}
+
+HeapScope::HeapScope(HeapAccount* account)
+    : m_previous(t_allocState.account)
+{
+    t_allocState.account = account;
+}
+
+HeapScope::~HeapScope()
+{
+    t_allocState.account = m_previous;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Counts heap allocations made by the calling thread. The counting is
+// done by AllocInterposer.o, which replaces malloc/calloc/realloc/free
+// (and the aligned variants) for the whole process, including code in
+// dlopen'ed robot libraries, so the counters see what a robot allocates
+// inside its callbacks. It is linked into the executables that want it
+// (RobotWarz, RobotWarz_static, test_robot), not into librobotwarz.a, so
+// a program embedding the library keeps its own allocator; without it the
+// counters and heap accounts below simply stay at zero.
+struct AllocStats {
+    uint64_t calls = 0;   // malloc/calloc/realloc/aligned calls
+    uint64_t bytes = 0;   // bytes requested by those calls
+};
+
+// Snapshot of this thread's counters. Take one before and after a call
+// and subtract to get that call's allocations.
+AllocStats threadAllocStats();
+
+inline AllocStats operator-(const AllocStats& a, const AllocStats& b)
+{
+    return AllocStats{a.calls - b.calls, a.bytes - b.bytes};
+}
+
+// Heap held by one owner (a robot): the usable size of blocks allocated
+// while it was the thread's current account, minus blocks freed while it
+// was. Blocks are charged to whoever is current when they are allocated
+// or freed, so memory an owner frees outside its own scopes (or another
+// owner's blocks it frees) is misattributed; robots keep their state to
+// themselves, so in practice neither happens.
+struct HeapAccount {
+    int64_t live = 0;
+    int64_t peak = 0;
+};
+
+// Makes account the calling thread's current account until the scope
+// ends (nullptr charges nobody). Scopes nest.
+class HeapScope {
+public:
+    explicit HeapScope(HeapAccount* account);
+    ~HeapScope();
+
+    HeapScope(const HeapScope&) = delete;
+    HeapScope& operator=(const HeapScope&) = delete;
+
+private:
+    HeapAccount* m_previous;
+};
+
+// Per-thread state behind the calls above, shared with the interposer.
+// Plain data with constant initialization, so it is safe to touch from
+// inside malloc.
+struct AllocThreadState {
+    uint64_t     calls   = 0;
+    uint64_t     bytes   = 0;
+    HeapAccount* account = nullptr;
+};
+
+extern thread_local AllocThreadState t_allocState;
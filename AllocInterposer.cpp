@@ -0,0 +1,92 @@
+#include "AllocHooks.h"
+
+#include <cstdlib>
+#include <cerrno>
+#include <malloc.h>
+
+// glibc exports its real allocator under these names, which lets us
+// wrap malloc without dlsym(RTLD_NEXT) (dlsym itself may allocate).
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void  __libc_free(void* ptr);
+}
+
+namespace {
+void* allocated(void* ptr, size_t size)
+{
+    AllocThreadState& state = t_allocState;
+    ++state.calls;
+    state.bytes += size;
+    if (ptr && state.account) {
+        HeapAccount* account = state.account;
+        account->live += static_cast<int64_t>(malloc_usable_size(ptr));
+        if (account->live > account->peak) account->peak = account->live;
+    }
+    return ptr;
+}
+}
+
+extern "C" {
+
+void* malloc(size_t size)
+{
+    return allocated(__libc_malloc(size), size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    return allocated(__libc_calloc(count, size), count * size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    AllocThreadState& state = t_allocState;
+    if (!state.account) {
+        ++state.calls;
+        state.bytes += size;
+        return __libc_realloc(ptr, size);
+    }
+
+    int64_t before = ptr ? static_cast<int64_t>(malloc_usable_size(ptr)) : 0;
+    void* moved = __libc_realloc(ptr, size);
+    if (!moved && size != 0) {
+        return allocated(nullptr, size);   // failed; ptr is untouched
+    }
+    state.account->live -= before;
+    return allocated(moved, size);
+}
+
+void free(void* ptr)
+{
+    HeapAccount* account = t_allocState.account;
+    if (ptr && account) {
+        account->live -= static_cast<int64_t>(malloc_usable_size(ptr));
+    }
+    __libc_free(ptr);
+}
+
+void* memalign(size_t alignment, size_t size)
+{
+    return allocated(__libc_memalign(alignment, size), size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size)
+{
+    return allocated(__libc_memalign(alignment, size), size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size)
+{
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    void* ptr = allocated(__libc_memalign(alignment, size), size);
+    if (!ptr && size != 0) return ENOMEM;
+    *out = ptr;
+    return 0;
+}
+
+}
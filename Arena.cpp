@@ -1,4 +1,7 @@
 #include "Arena.h"
+#include "RobotRegistry.h"
+#include "Trace.h"
+#include "BoardScan.h"
 
 #include <iostream>
 #include <iomanip>
@@ -10,50 +13,225 @@
 #include <thread>
 #include <stdexcept>
 #include <cmath>
+#include <algorithm>
 
 namespace fs = std::filesystem;
 
 namespace {
-int directionFromDelta(int dr, int dc)
+// Stream ids mixed into the match seed so each kind of randomness gets
+// its own independent sequence.
+enum RngStream : uint32_t { MapStream = 1, SpawnStream = 2, DamageStream = 3 };
+
+std::mt19937 makeStream(uint32_t seed, uint32_t stream, uint32_t slot = 0)
+{
+    std::seed_seq seq{seed, stream, slot};
+    return std::mt19937(seq);
+}
+
+thread_local std::ostream nullLog(nullptr);
+
+const std::string robotSymbols = "!@#$%^&*?";
+
+// Stands in for a robot whose factory failed at the start of a match
+// (a pooled robot whose workers keep dying, say). It is out of the match
+// before the first turn, so its callbacks are never made.
+class BenchedRobot : public RobotBase
 {
-    if (dr == 0 && dc == 0) return 0;
+public:
+    explicit BenchedRobot(const std::string& name) : RobotBase(2, 0, hammer)
+    {
+        m_name = name;
+    }
 
-    if (dr < 0 && dc == 0)  return 1; // Up
-    if (dr < 0 && dc > 0)   return 2; // Up-right
-    if (dr == 0 && dc > 0)  return 3; // Right
-    if (dr > 0 && dc > 0)   return 4; // Down-right
-    if (dr > 0 && dc == 0)  return 5; // Down
-    if (dr > 0 && dc < 0)   return 6; // Down-left
-    if (dr == 0 && dc < 0)  return 7; // Left
-    if (dr < 0 && dc < 0)   return 8; // Up-left
+    void get_radar_direction(int& radar_direction) override { radar_direction = 1; }
+    void process_radar_results(const std::vector<RadarObj>&) override {}
+    bool get_shot_location(int&, int&) override { return false; }
+    void get_move_direction(int& direction, int& distance) override
+    {
+        direction = 0;
+        distance  = 0;
+    }
+};
 
-    return 0;
+ArenaConfig sizedConfig(int rows, int cols, std::optional<uint32_t> seed)
+{
+    ArenaConfig config;
+    config.rows = rows;
+    config.cols = cols;
+    config.seed = seed;
+    return config;
 }
 }
 
 Arena::Arena(int rows, int cols)
-    : m_rows(rows),
-      m_cols(cols),
-      m_board(rows, std::vector<char>(cols, '.'))
+    : Arena(sizedConfig(rows, cols, std::nullopt))
+{
+}
+
+Arena::Arena(int rows, int cols, uint32_t seed)
+    : Arena(sizedConfig(rows, cols, seed))
+{
+}
+
+Arena::Arena(const ArenaConfig& config)
+    : m_rows(config.rows),
+      m_cols(config.cols),
+      m_numMounds(config.numMounds),
+      m_numPits(config.numPits),
+      m_numFlamers(config.numFlamers),
+      m_maxRounds(config.maxRounds),
+      m_watchLive(config.watchLive),
+      m_heapCapKb(config.heapCapKb),
+      m_seed(config.seed ? *config.seed : std::random_device{}()),
+      m_maps(config.maps)
 {
-    if (rows < 10 || cols < 10) {
+    if (m_rows < 10 || m_cols < 10) {
         throw std::runtime_error("Arena must be at least 10x10.");
     }
+    if (m_maps && (m_maps->rows() != m_rows || m_maps->cols() != m_cols)) {
+        throw std::runtime_error("Map pack is " + std::to_string(m_maps->rows()) + "x" +
+                                 std::to_string(m_maps->cols()) + ", arena is " +
+                                 std::to_string(m_rows) + "x" + std::to_string(m_cols) + ".");
+    }
 
+    m_board.assign(static_cast<size_t>(m_rows) * m_cols, '.');
+    m_geometry = BoardGeometry(m_rows, m_cols);
+    m_boardByCol.assign(m_board.size(), '.');
+    m_radarCache.resize(static_cast<size_t>(m_rows) * m_cols);
+    m_robotAtCell.assign(m_board.size(), -1);
+    m_liveInRow.assign(m_rows, 0);
+    m_liveInCol.assign(m_cols, 0);
+    m_liveInDiag.assign(m_rows + m_cols - 1, 0);
+    m_liveInAnti.assign(m_rows + m_cols - 1, 0);
+
+    seedStreams();
     initBoard();
 }
 
+void Arena::seedStreams() {
+    m_mapRng   = makeStream(m_seed, MapStream);
+    m_spawnRng = makeStream(m_seed, SpawnStream);
+    for (size_t i = 0; i < m_robots.size(); ++i) {
+        m_robots[i].damageRng =
+            makeStream(m_seed, DamageStream, static_cast<uint32_t>(i));
+    }
+
+    // Robots draw from std::rand() for their own decisions; pin that too
+    // so paired runs only differ by the robot code under test.
+    std::srand(m_seed);
+}
+
+void Arena::newMatch(uint32_t seed) {
+    m_seed = seed;
+
+    std::vector<RobotInfo*> benched;
+    for (auto& info : m_robots) {
+        // the previous match's robot (and all its state) goes first
+        info.robot.reset();
+        info.heap = {};
+        try {
+            HeapScope heap(&info.heap);
+            info.robot.reset(info.factory());
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Cannot create " << info.source << ": " << e.what() << "\n";
+        }
+        if (!info.robot) {
+            // the slot keeps its place (and the seed its spawns) but sits
+            // the match out
+            std::cerr << info.source << " sits out the match with seed " << seed << "\n";
+            info.robot = std::make_unique<BenchedRobot>(info.name);
+            benched.push_back(&info);
+        }
+        info.async = dynamic_cast<AsyncRobot*>(info.robot.get());
+        info.robot->set_boundaries(m_rows, m_cols);
+        info.name  = info.robot->m_name;
+        info.alive = true;
+        info.inPit = false;
+        info.stats = {};
+        info.row   = 0;
+        info.col   = 0;
+    }
+
+    seedStreams();
+    initBoard();
+    startMatch();
+
+    for (RobotInfo* info : benched) {
+        countLive(*info, -1);
+        info->alive = false;
+        --m_aliveCount;
+        recordEvent(ArenaEvent::Death, *info, info->row, info->col);
+    }
+}
+
+void Arena::startMatch() {
+    // Robot constructors may have reseeded std::rand() (e.g. with the
+    // time), so pin it again now that they all exist.
+    std::srand(m_seed);
+
+    std::fill(m_liveInRow.begin(),  m_liveInRow.end(),  0);
+    std::fill(m_liveInCol.begin(),  m_liveInCol.end(),  0);
+    std::fill(m_liveInDiag.begin(), m_liveInDiag.end(), 0);
+    std::fill(m_liveInAnti.begin(), m_liveInAnti.end(), 0);
+    std::fill(m_robotAtCell.begin(), m_robotAtCell.end(), -1);
+    placeRobotsRandomly();
+
+    m_turnOrder.resize(m_robots.size());
+    for (size_t i = 0; i < m_robots.size(); ++i) {
+        m_turnOrder[i] = static_cast<int32_t>(i);
+    }
+    m_aliveCount = countAliveRobots();
+
+    if (Trace::enabled()) {
+        for (const auto& info : m_robots) {
+            Trace::labelRobot(slotOf(info), label(info));
+        }
+    }
+
+    m_roundsPlayed = 0;
+    m_turnCursor   = 0;
+    m_winner       = -1;
+    m_started      = true;
+    m_matchStart   = std::chrono::steady_clock::now();
+    m_events.clear();
+
+    if (m_feed || m_replay) {
+        ++m_feedMatch;
+        publishFrame(-1);
+    }
+}
+
+std::ostream& Arena::log() const {
+    return m_watchLive ? std::cout : nullLog;
+}
+
 void Arena::loadConfig(const std::string& /*filename*/) {
 
 }
 
 void Arena::initBoard() {
+    if (m_maps) {
+        const char* cells = m_maps->cells(m_seed % m_maps->size());
+        std::copy(cells, cells + m_board.size(), m_board.begin());
+    } else {
+        std::fill(m_board.begin(), m_board.end(), '.');
+        placeObstacles();
+    }
+
+    // column-major copy, so vertical rays are contiguous too
     for (int r = 0; r < m_rows; ++r) {
         for (int c = 0; c < m_cols; ++c) {
-            m_board[r][c] = '.';
+            m_boardByCol[c * m_rows + r] = m_board[r * m_cols + c];
         }
     }
-    placeObstacles();
+
+    // new terrain: every cached radar ray is stale
+    ++m_terrainGeneration;
+}
+
+int Arena::slotOf(const RobotInfo& info) const {
+    return static_cast<int>(&info - m_robots.data());
 }
 
 bool Arena::inBounds(int r, int c) const {
@@ -61,7 +239,7 @@ bool Arena::inBounds(int r, int c) const {
 }
 
 void Arena::placeObstacles() {
-    std::mt19937 rng(std::random_device{}());
+    auto& rng = m_mapRng;
     std::uniform_int_distribution<int> rowDist(0, m_rows - 1);
     std::uniform_int_distribution<int> colDist(0, m_cols - 1);
 
@@ -70,8 +248,8 @@ void Arena::placeObstacles() {
         while (placed < count) {
             int r = rowDist(rng);
             int c = colDist(rng);
-            if (m_board[r][c] == '.') {
-                m_board[r][c] = ch;
+            if (m_board[r * m_cols + c] == '.') {
+                m_board[r * m_cols + c] = ch;
                 ++placed;
             }
         }
@@ -83,13 +261,124 @@ void Arena::placeObstacles() {
 }
 
 char Arena::symbolForRobot(size_t index) const {
-    static const std::string symbols = "!@#$%^&*?";
-    return symbols[index % symbols.size()];
+    return robotSymbols[index % robotSymbols.size()];
+}
+
+std::string Arena::label(const RobotInfo& info) const {
+    if (m_robots.size() <= robotSymbols.size()) {
+        return info.name + " " + info.symbol;
+    }
+    return info.name + " #" + std::to_string(info.id);
+}
+
+bool Arena::addRobot(RobotFactory factory, const std::string& source) {
+    return addRobot(RegisteredRobot{source, factory, nullptr}, m_robots.size());
+}
+
+bool Arena::addRobot(const RegisteredRobot& robot) {
+    return addRobot(robot, m_robots.size());
+}
+
+bool Arena::replaceRobot(const RegisteredRobot& entry) {
+    bool underway = m_roundsPlayed > 0 || m_turnCursor > 0;
+    if (m_started && !matchOver() && underway) {
+        throw std::runtime_error("replaceRobot(" + entry.source +
+                                 ") called during a match");
+    }
+
+    // a large match may field many copies of the same source
+    bool replaced = false;
+    for (auto& info : m_robots) {
+        if (info.source != entry.source) continue;
+        if (info.factory == entry.factory) continue;
+
+        HeapAccount account;
+        std::unique_ptr<RobotBase> robot;
+        {
+            HeapScope heap(&account);
+            robot.reset(entry.factory());
+        }
+        if (!robot) {
+            std::cerr << "create_robot() returned nullptr for "
+                      << entry.source << "\n";
+            return replaced;
+        }
+        robot->set_boundaries(m_rows, m_cols);
+
+        // the old robot's code lives in the old library, so it must be
+        // deleted before that reference is dropped
+        info.robot.reset();
+        info.library = entry.library;
+        info.factory = entry.factory;
+        info.robot   = std::move(robot);
+        info.async   = dynamic_cast<AsyncRobot*>(info.robot.get());
+        info.name    = info.robot->m_name;
+        info.heap    = account;
+        replaced     = true;
+    }
+    return replaced;
+}
+
+std::vector<RegisteredRobot> Arena::roster() const {
+    std::vector<RegisteredRobot> robots;
+    for (const auto& info : m_robots) {
+        robots.push_back(RegisteredRobot{info.source, info.factory, info.library});
+    }
+    return robots;
+}
+
+bool Arena::addRobot(const RegisteredRobot& entry, size_t slot) {
+    HeapAccount account;
+    std::unique_ptr<RobotBase> robot;
+    {
+        HeapScope heap(&account);
+        robot.reset(entry.factory());
+    }
+    if (!robot) {
+        std::cerr << "create_robot() returned nullptr for "
+                  << entry.source << "\n";
+        return false;
+    }
+
+    robot->set_boundaries(m_rows, m_cols);
+
+    RobotInfo info;
+    info.library  = entry.library;
+    info.factory  = entry.factory;
+    info.source   = entry.source;
+    info.name     = robot->m_name;
+    info.robot    = std::move(robot);
+    info.async    = dynamic_cast<AsyncRobot*>(info.robot.get());
+    // id indexes m_robots; slot (the source's place in the sorted list,
+    // which skips any that failed to build) only picks the glyph
+    info.id       = static_cast<uint32_t>(m_robots.size());
+    info.symbol   = symbolForRobot(slot);
+    info.alive    = true;
+    info.inPit    = false;
+    info.heap     = account;
+    info.damageRng = makeStream(m_seed, DamageStream,
+                                static_cast<uint32_t>(m_robots.size()));
+
+    m_robots.push_back(std::move(info));
+    return true;
 }
 
 void Arena::loadRobots() {
     std::cout << "Loading Robots...\n";
 
+    // Static build: robots are already linked in, skip the compiler and
+    // the dynamic loader entirely.
+    const auto& registry = registeredRobots();
+    if (!registry.empty()) {
+        for (size_t i = 0; i < registry.size(); ++i) {
+            std::cout << "Using built-in " << registry[i].source << "\n";
+            addRobot(registry[i], i);
+        }
+
+        startMatch();
+        return;
+    }
+
     std::vector<fs::path> robotSources;
     for (const auto& entry : fs::directory_iterator(".")) {
         if (!entry.is_regular_file()) continue;
@@ -103,6 +392,10 @@ void Arena::loadRobots() {
         std::cout << "No Robot_*.cpp files found.\n";
     }
 
+    // directory_iterator order is unspecified; sort so a robot keeps the
+    // same slot (and therefore the same spawn and damage stream) per seed.
+    std::sort(robotSources.begin(), robotSources.end());
+
     for (size_t i = 0; i < robotSources.size(); ++i) {
         const auto& srcPath = robotSources[i];
         std::string filename  = srcPath.filename().string();
@@ -110,86 +403,74 @@ void Arena::loadRobots() {
         std::string base      = srcPath.stem().string();
         std::string sharedLib = "lib" + base + ".so";
 
-        std::string compileCmd =
-            "g++ -shared -fPIC -o " + sharedLib + " " + filename +
-            " RobotBase.o -I. -std=c++20";
-
         std::cout << "Compiling " << filename << " to " << sharedLib << "...\n";
-        int compileResult = std::system(compileCmd.c_str());
-        if (compileResult != 0) {
-            std::cerr << "Failed to compile " << filename
-                      << " with command: " << compileCmd << "\n";
+        if (!RobotLibrary::compile(filename, sharedLib)) {
             continue;
         }
 
         std::string soPath = "./" + sharedLib;
-        void* handle = dlopen(soPath.c_str(), RTLD_LAZY);
-        if (!handle) {
-            std::cerr << "Failed to load " << soPath
-                      << ": " << dlerror() << "\n";
-            continue;
-        }
-
-        RobotFactory create_robot =
-            (RobotFactory)dlsym(handle, "create_robot");
-        if (!create_robot) {
-            std::cerr << "Failed to find create_robot in " << soPath
-                      << ": " << dlerror() << "\n";
-            dlclose(handle);
+        auto library = RobotLibrary::open(soPath);
+        if (!library) {
             continue;
         }
 
-        RobotBase* robot = create_robot();
-        if (!robot) {
-            std::cerr << "create_robot() returned nullptr for "
-                      << soPath << "\n";
-            dlclose(handle);
-            continue;
-        }
-
-        robot->set_boundaries(m_rows, m_cols);
-
-        RobotInfo info;
-        info.robot    = robot;
-        info.soHandle = handle;
-        info.name     = robot->m_name;
-        info.symbol   = symbolForRobot(i);
-        info.alive    = true;
-        info.inPit    = false;
-
-        m_robots.push_back(info);
+        // on failure the library is released (and dlclose'd) here
+        addRobot(RegisteredRobot{base, library->factory(), library}, i);
     }
 
-    placeRobotsRandomly();
+    startMatch();
 }
 
 void Arena::placeRobotsRandomly() {
-    std::mt19937 rng(std::random_device{}());
+    auto& rng = m_spawnRng;
+
+    // A map from a pack brings its own spawn points; deal them out in a
+    // seed-dependent order.
+    if (m_maps) {
+        size_t map = m_seed % m_maps->size();
+        size_t count = static_cast<size_t>(m_maps->spawnCount(map));
+        if (count >= m_robots.size()) {
+            const MapSpawn* spawns = m_maps->spawns(map);
+            std::vector<size_t> order(count);
+            for (size_t i = 0; i < count; ++i) {
+                order[i] = i;
+            }
+            std::shuffle(order.begin(), order.end(), rng);
+
+            for (size_t i = 0; i < m_robots.size(); ++i) {
+                RobotInfo& info = m_robots[i];
+                info.row = spawns[order[i]].row;
+                info.col = spawns[order[i]].col;
+                info.robot->move_to(info.row, info.col);
+                m_robotAtCell[info.row * m_cols + info.col] = static_cast<int32_t>(i);
+                countLive(info, +1);
+            }
+            return;
+        }
+    }
+
     std::uniform_int_distribution<int> rowDist(0, m_rows - 1);
     std::uniform_int_distribution<int> colDist(0, m_cols - 1);
 
-    for (auto& info : m_robots) {
+    for (size_t i = 0; i < m_robots.size(); ++i) {
+        RobotInfo& info = m_robots[i];
         while (true) {
             int r = rowDist(rng);
             int c = colDist(rng);
+            int cell = r * m_cols + c;
 
-            bool occupied = false;
-            if (m_board[r][c] != '.') {
-                occupied = true;
-            } else {
-                for (const auto& other : m_robots) {
-                    if (&other == &info) continue;
-                    if (other.row == r && other.col == c) {
-                        occupied = true;
-                        break;
-                    }
-                }
-            }
+            // Robots still waiting to be placed stand at (0,0), so that
+            // cell counts as taken until the last robot; keeping that
+            // keeps existing seeds' spawns unchanged.
+            bool occupied = m_board[cell] != '.' || m_robotAtCell[cell] >= 0 ||
+                            (cell == 0 && i + 1 < m_robots.size());
 
             if (!occupied) {
                 info.row = r;
                 info.col = c;
                 info.robot->move_to(r, c);
+                m_robotAtCell[cell] = static_cast<int32_t>(i);
+                countLive(info, +1);
                 break;
             }
         }
@@ -197,6 +478,8 @@ void Arena::placeRobotsRandomly() {
 }
 
 void Arena::printBoard(int round) const {
+    if (!m_watchLive) return;
+
     std::cout << "\n=========== starting round " << round << " ===========\n\n";
 
     std::cout << "   ";
@@ -205,89 +488,376 @@ void Arena::printBoard(int round) const {
     }
     std::cout << "\n";
 
-    auto temp = m_board;
-
-    for (const auto& info : m_robots) {
-        char ch;
-        if (!info.alive || info.robot->get_health() <= 0) {
-            ch = 'X';
-        } else {
-            ch = info.symbol;
-        }
-        if (inBounds(info.row, info.col)) {
-            temp[info.row][info.col] = ch;
-        }
-    }
-
     for (int r = 0; r < m_rows; ++r) {
         std::cout << std::setw(2) << r << " ";
         for (int c = 0; c < m_cols; ++c) {
-            std::cout << " " << temp[r][c] << " ";
+            int  cell = r * m_cols + c;
+            int  slot = m_robotAtCell[cell];
+            char ch   = m_board[cell];
+            if (slot >= 0) {
+                ch = isAlive(m_robots[slot]) ? m_robots[slot].symbol : 'X';
+            }
+            std::cout << " " << ch << " ";
         }
         std::cout << "\n\n";
     }
 }
 
 void Arena::printRobotStatus(const RobotInfo& info) const {
-    std::cout << info.name << " " << info.symbol << " begins turn.\n";
+    if (!m_watchLive) return;
+
+    std::cout << label(info) << " begins turn.\n";
     std::cout << "  " << info.robot->print_stats() << "\n";
 }
 
-void Arena::run() {
-    int round = 0;
-
-    while (!isGameOver() && round < m_maxRounds) {
-        printBoard(round);
-        runRound(round);
-        ++round;
+int Arena::run() {
+    TRACE_VALUE_SCOPE("match", static_cast<int32_t>(m_seed & 0x7FFFFFFF));
+    if (!m_started) startMatch();
+    m_matchStart = std::chrono::steady_clock::now();
 
-        if (m_watchLive) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-        }
+    while (stepRound()) {
     }
 
-    int winner = getWinnerIndex();
+    int winner = finishMatch();
     if (winner >= 0) {
-        std::cout << "Game Over. Winner: "
-                  << m_robots[winner].name
-                  << " " << m_robots[winner].symbol << "\n";
+        log() << "Game Over. Winner: " << label(m_robots[winner]) << "\n";
     } else {
-        std::cout << "Game Over. No winner (draw).\n";
+        log() << "Game Over. No winner (draw).\n";
     }
+    return winner;
 }
 
-void Arena::runRound(int /*round*/) {
-    for (auto& info : m_robots) {
-        if (!info.alive || info.robot->get_health() <= 0) {
-            continue;
+int Arena::finishMatch() {
+    m_wallNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - m_matchStart).count();
+    m_winner = getWinnerIndex();
+    return m_winner;
+}
+
+bool Arena::matchOver() const {
+    return m_started && m_turnCursor == 0 &&
+           (isGameOver() || m_roundsPlayed >= m_maxRounds);
+}
+
+bool Arena::step() {
+    if (!m_started) startMatch();
+    if (matchOver()) return false;
+
+    playTurn().wait();
+    return !matchOver();
+}
+
+Task Arena::playTurn() {
+    if (m_turnCursor == 0) {
+        printBoard(m_roundsPlayed);
+    }
+
+    auto skipDead = [&] {
+        while (m_turnCursor < m_turnOrder.size() &&
+               !isAlive(m_robots[m_turnOrder[m_turnCursor]])) {
+            ++m_turnCursor;
         }
+    };
+
+    skipDead();
+    if (m_turnCursor < m_turnOrder.size()) {
+        int slot = m_turnOrder[m_turnCursor];
+        co_await robotTurn(m_robots[slot]);
+        if (m_feed || m_replay) publishFrame(slot);
+        ++m_turnCursor;
+        skipDead();
+    }
+
+    if (m_turnCursor >= m_turnOrder.size()) {
+        endRound();
+    }
+}
+
+bool Arena::stepRound() {
+    if (!m_started) startMatch();
+    if (matchOver()) return false;
+
+    playRound().wait();
+    return !matchOver();
+}
+
+Task Arena::playRound() {
+    if (!m_started) startMatch();
+    if (matchOver()) co_return;
 
-        printRobotStatus(info);
+    // The round stays open while its turns wait on async robots, and a
+    // scheduler plays other arenas' turns on this thread meanwhile, so it
+    // is an async span keyed by arena rather than a nested scope.
+    TRACE_ASYNC_VALUE_SCOPE("runRound", reinterpret_cast<uintptr_t>(this), m_roundsPlayed);
 
-        int radarDir = 0;
+    do {
+        co_await playTurn();
+    } while (m_turnCursor != 0);
+}
+
+Task Arena::playMatch() {
+    if (!m_started) startMatch();
+
+    while (!matchOver()) {
+        co_await playRound();
+    }
+}
+
+void Arena::endRound() {
+    // drop this round's dead so the next round only visits the living
+    m_turnOrder.erase(std::remove_if(m_turnOrder.begin(), m_turnOrder.end(),
+                                     [this](int32_t slot) { return !isAlive(m_robots[slot]); }),
+                      m_turnOrder.end());
+    m_turnCursor = 0;
+    ++m_roundsPlayed;
+
+    if (m_watchLive) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+}
+
+char Arena::cellAt(int r, int c) const {
+    return inBounds(r, c) ? m_board[r * m_cols + c] : '\0';
+}
+
+int Arena::robotAt(int r, int c) const {
+    return inBounds(r, c) ? m_robotAtCell[r * m_cols + c] : -1;
+}
+
+RobotState Arena::robotState(size_t index) const {
+    const RobotInfo& info = m_robots.at(index);
+    RobotBase* robot = info.robot.get();
+    return RobotState{info.name, info.id, info.symbol, info.row, info.col,
+                      robot->get_health(), robot->get_armor(),
+                      robot->get_move_speed(), robot->get_weapon(),
+                      robot->get_grenades(), isAlive(info), info.inPit};
+}
+
+void Arena::recordEvent(ArenaEvent::Type type, const RobotInfo& info,
+                        int row, int col, int value, int other) {
+    if (!m_recordEvents) return;
+    m_events.push_back(ArenaEvent{type, m_roundsPlayed, slotOf(info),
+                                  other, row, col, value});
+}
+
+uint64_t Arena::configHash() const {
+    // FNV-1a over the settings, and the map pack and heap cap if set (so
+    // hashes of runs without them stay what they were)
+    const int64_t settings[] = {m_rows, m_cols, m_numMounds, m_numPits,
+                                m_numFlamers, m_maxRounds,
+                                m_maps ? static_cast<int64_t>(m_maps->hash()) : 0,
+                                m_heapCapKb};
+    size_t count = m_heapCapKb ? 8 : m_maps ? 7 : 6;
+
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < count; ++i) {
+        for (int b = 0; b < 8; ++b) {
+            hash ^= static_cast<uint64_t>(settings[i] >> (8 * b)) & 0xFF;
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+MatchRecord Arena::matchRecord() const {
+    MatchRecord rec;
+    rec.seed       = m_seed;
+    rec.configHash = configHash();
+    rec.wallNanos  = m_wallNanos;
+    rec.winner     = m_winner;
+    rec.rounds     = static_cast<uint32_t>(m_roundsPlayed);
+
+    for (const auto& info : m_robots) {
+        RobotMatchStats r;
+        r.name        = label(info);
+        r.damageDealt = info.stats.damageDealt;
+        r.damageTaken = info.stats.damageTaken;
+        r.shots       = info.stats.shots;
+        r.moves       = info.stats.moves;
+        r.pitEvents   = info.stats.pitEvents;
+        r.flameEvents = info.stats.flameEvents;
+        r.survived    = info.alive && info.robot->get_health() > 0;
+        r.heapKb      = static_cast<uint32_t>(info.heap.peak / 1024);
+        rec.robots.push_back(r);
+    }
+    return rec;
+}
+
+RobotReply Arena::robotCall(RobotInfo& info, AsyncRobot::Call call,
+                             const std::vector<RadarObj>* radar) {
+    if (info.async) info.async->begin_call(call, radar);
+    return RobotReply{info.async};
+}
+
+// One robot's turn. Each callback is preceded by co_await robotCall(),
+// which only suspends for an AsyncRobot that hasn't answered yet (the
+// time it spends waiting is charged to its robot code in --perf).
+Task Arena::robotTurn(RobotInfo& info) {
+    int slot = slotOf(info);
+
+    printRobotStatus(info);
+
+    PerfCounters::Sample mark{};
+    if (m_perf) mark = m_perf->read();
+
+    int radarDir = 0;
+    co_await robotCall(info, AsyncRobot::RadarDirection);
+    {
+        TRACE_ROBOT_SCOPE("get_radar_direction", slot);
+        HeapScope heap(&info.heap);
         info.robot->get_radar_direction(radarDir);
-        auto radarResults = makeRadar(info, radarDir);
-        info.robot->process_radar_results(radarResults);
+    }
+    perfCharge(PerfReport::RobotCode, slot, mark);
+    if (forfeitOverHeapCap(info)) co_return;
 
-        int shotRow = 0;
-        int shotCol = 0;
-        bool willShoot = info.robot->get_shot_location(shotRow, shotCol);
+    makeRadar(info, radarDir, m_radarResults);
+    perfCharge(PerfReport::Radar, slot, mark);
 
-        if (willShoot) {
-            handleShot(info, shotRow, shotCol);
-        } else {
-            int moveDir = 0;
-            int distance = 0;
+    int shotRow = 0;
+    int shotCol = 0;
+    bool willShoot = false;
+    co_await robotCall(info, AsyncRobot::ProcessRadar, &m_radarResults);
+    {
+        TRACE_ROBOT_SCOPE("process_radar_results", slot);
+        HeapScope heap(&info.heap);
+        info.robot->process_radar_results(m_radarResults);
+    }
+    if (forfeitOverHeapCap(info)) co_return;
+    co_await robotCall(info, AsyncRobot::ShotLocation);
+    {
+        TRACE_ROBOT_SCOPE("get_shot_location", slot);
+        HeapScope heap(&info.heap);
+        willShoot = info.robot->get_shot_location(shotRow, shotCol);
+    }
+    perfCharge(PerfReport::RobotCode, slot, mark);
+    if (forfeitOverHeapCap(info)) co_return;
+
+    if (willShoot) {
+        handleShot(info, shotRow, shotCol);
+        perfCharge(PerfReport::Shot, slot, mark);
+    } else {
+        int moveDir = 0;
+        int distance = 0;
+        co_await robotCall(info, AsyncRobot::MoveDirection);
+        {
+            TRACE_ROBOT_SCOPE("get_move_direction", slot);
+            HeapScope heap(&info.heap);
             info.robot->get_move_direction(moveDir, distance);
-            handleMovement(info, moveDir, distance);
         }
+        perfCharge(PerfReport::RobotCode, slot, mark);
+        if (forfeitOverHeapCap(info)) co_return;
 
-        std::cout << "\n";
+        handleMovement(info, moveDir, distance);
+        perfCharge(PerfReport::Move, slot, mark);
     }
+
+    log() << "\n";
+}
+
+// A robot over the heap cap is out on the spot, its turn unfinished.
+bool Arena::forfeitOverHeapCap(RobotInfo& info) {
+    if (m_heapCapKb == 0 || info.heap.live <= int64_t(m_heapCapKb) * 1024) {
+        return false;
+    }
+
+    countLive(info, -1);
+    info.alive = false;
+    --m_aliveCount;
+    recordEvent(ArenaEvent::Death, info, info.row, info.col);
+    log() << "  " << info.name << " holds " << info.heap.live / 1024
+          << " kB of heap (cap " << m_heapCapKb << " kB) and forfeits!\n";
+    return true;
+}
+
+void Arena::perfCharge(PerfReport::Phase phase, int slot, PerfCounters::Sample& mark) {
+    if (!m_perf) return;
+
+    PerfCounters::Sample now = m_perf->read();
+    PerfCounters::Sample delta;
+    for (size_t e = 0; e < delta.size(); ++e) {
+        delta[e] = now[e] - mark[e];
+    }
+    m_perfReport.add(phase, static_cast<size_t>(slot), delta);
+    mark = now;
+}
+
+bool Arena::enablePerfCounters() {
+    auto counters = std::make_unique<PerfCounters>();
+    if (!counters->available()) {
+        return false;
+    }
+    m_perf = std::move(counters);
+    return true;
+}
+
+void Arena::printPerfReport(std::ostream& out) const {
+    if (!m_perf) return;
+
+    std::vector<std::string> names;
+    for (const auto& info : m_robots) {
+        names.push_back(label(info));
+    }
+    m_perfReport.print(out, *m_perf, names);
+}
+
+void Arena::enableSpectatorFeed(const std::string& name) {
+    m_feed = std::make_unique<SpectatorFeed>(name, m_rows, m_cols, m_robots.size());
+    if (m_started) {
+        ++m_feedMatch;
+        publishFrame(-1);
+    }
+}
+
+void Arena::enableReplay(const std::string& path) {
+    m_replay = std::make_unique<ReplayWriter>(path, m_rows, m_cols);
+    if (m_started) {
+        ++m_feedMatch;
+        publishFrame(-1);
+    }
+}
+
+void Arena::publishFrame(int turn) {
+    FeedFrame frame{};
+    frame.match  = m_feedMatch;
+    frame.seed   = m_seed;
+    frame.round  = static_cast<uint32_t>(m_roundsPlayed);
+    frame.turn   = turn;
+    frame.kind   = turn < 0 ? FeedFrame::Key : FeedFrame::Turn;
+    frame.robots = static_cast<uint16_t>(m_robots.size());
+
+    m_feedRobots.resize(m_robots.size());
+    for (size_t i = 0; i < m_robots.size(); ++i) {
+        const RobotInfo& info = m_robots[i];
+        FeedRobot& r = m_feedRobots[i];
+        r.symbol = info.symbol;
+        r.flags  = (isAlive(info) ? FeedRobot::Alive : 0) |
+                   (info.inPit ? FeedRobot::InPit : 0);
+        r.row    = static_cast<uint16_t>(info.row);
+        r.col    = static_cast<uint16_t>(info.col);
+        r.health = static_cast<int16_t>(info.robot->get_health());
+        r.armor  = static_cast<int16_t>(info.robot->get_armor());
+    }
+
+    if (frame.kind == FeedFrame::Key) {
+        m_feedNames.assign(feedNameBytes * m_robots.size(), '\0');
+        for (size_t i = 0; i < m_robots.size(); ++i) {
+            std::string name = label(m_robots[i]);
+            name.copy(&m_feedNames[feedNameBytes * i], feedNameBytes - 1);
+        }
+        if (m_feed) m_feed->publish(frame, m_feedRobots.data(), m_feedNames.data(), m_board.data());
+        if (m_replay) m_replay->record(frame, m_feedRobots.data(), m_feedNames.data(), m_board.data());
+    } else {
+        if (m_feed) m_feed->publish(frame, m_feedRobots.data());
+        if (m_replay) m_replay->record(frame, m_feedRobots.data());
+    }
+}
+
+bool Arena::isAlive(const RobotInfo& info) const {
+    return info.alive && info.robot->get_health() > 0;
 }
 
 bool Arena::isGameOver() const {
-    return countAliveRobots() <= 1;
+    return m_aliveCount <= 1;
 }
 
 int Arena::countAliveRobots() const {
@@ -315,89 +885,203 @@ int Arena::getWinnerIndex() const {
 }
 
 bool Arena::cellHasRobot(int r, int c, int& robotIndexOut) const {
-    for (int i = 0; i < static_cast<int>(m_robots.size()); ++i) {
-        if (m_robots[i].alive &&
-            m_robots[i].row == r &&
-            m_robots[i].col == c) {
-            robotIndexOut = i;
-            return true;
-        }
-    }
-    return false;
+    int slot = robotAt(r, c);
+    if (slot < 0 || !m_robots[slot].alive) return false;
+    robotIndexOut = slot;
+    return true;
 }
 
-std::vector<RadarObj> Arena::makeRadar(const RobotInfo& info,
-                                       int radarDirection) const {
-    std::vector<RadarObj> results;
+void Arena::makeRadar(const RobotInfo& info, int radarDirection,
+                      std::vector<RadarObj>& results) const {
+    TRACE_ROBOT_SCOPE("makeRadar", slotOf(info));
+
+    results.clear();
+
+    if (radarDirection < 0 || radarDirection > 8) {
+        return;
+    }
 
     int r0 = info.row;
     int c0 = info.col;
 
-    auto addCell = [&](int r, int c) {
-        if (!inBounds(r, c)) return;
-        if (r == r0 && c == c0) return;
-
-        char ch = m_board[r][c];
+    const RadarRay& ray = radarRay(r0, c0, radarDirection);
+    results.assign(ray.cells.begin(), ray.cells.end());
 
+    // Overlay the robots: with few robots, find each one on the ray; with
+    // more robots than ray cells, look each cell up in the cell index.
+    if (m_robots.size() <= ray.cells.size()) {
         for (const auto& rob : m_robots) {
-            if (rob.row == r && rob.col == c) {
-                if (!rob.alive || rob.robot->get_health() <= 0) {
-                    ch = 'X';
-                } else {
-                    ch = 'R';
-                }
-                break;
-            }
+            int at = ray.find(radarDirection, rob.row - r0, rob.col - c0);
+            if (at < 0) continue;
+            results[at].m_type = isAlive(rob) ? 'R' : 'X';
+        }
+    } else {
+        for (auto& obj : results) {
+            int slot = m_robotAtCell[obj.m_row * m_cols + obj.m_col];
+            if (slot < 0) continue;
+            obj.m_type = isAlive(m_robots[slot]) ? 'R' : 'X';
         }
+    }
+}
+
+const Arena::RadarRay& Arena::radarRay(int r0, int c0, int radarDirection) const {
+    auto& perCell = m_radarCache[static_cast<size_t>(r0) * m_cols + c0];
+    if (!perCell) {
+        if (m_radarCacheBytes >= radarCacheBudget) {
+            fillRadarRay(m_radarScratch, r0, c0, radarDirection);
+            return m_radarScratch;
+        }
+        perCell = std::make_unique<RadarRay[]>(9);
+    }
 
-        results.emplace_back(ch, r, c);
+    RadarRay& ray = perCell[radarDirection];
+    if (ray.generation == m_terrainGeneration) {
+        return ray;
+    }
+
+    auto bytes = [](const RadarRay& r) {
+        return r.cells.capacity() * sizeof(RadarObj) + r.index.capacity() * sizeof(int32_t);
     };
+    size_t before = bytes(ray);
+    fillRadarRay(ray, r0, c0, radarDirection);
+    ray.generation = m_terrainGeneration;
+    m_radarCacheBytes += bytes(ray) - before;
+    return ray;
+}
 
-    if (radarDirection == 0) {
-        for (int dr = -1; dr <= 1; ++dr) {
-            for (int dc = -1; dc <= 1; ++dc) {
-                if (dr == 0 && dc == 0) continue;
-                int rr = r0 + dr;
-                int cc = c0 + dc;
-                addCell(rr, cc);
-            }
+void Arena::fillRadarRay(RadarRay& ray, int r0, int c0, int radarDirection) const {
+    ray.cells.clear();
+    ray.index.clear();
+
+    const BoardGeometry& geo = m_geometry;
+    auto addCell = [&](int32_t cell) {
+        if (cell == BoardGeometry::offBoard) {
+            ray.index.push_back(-1);
+            return;
         }
-        return results;
-    }
+        ray.index.push_back(static_cast<int32_t>(ray.cells.size()));
+        ray.cells.emplace_back(m_board[cell], geo.row(cell), geo.col(cell));
+    };
+
+    int32_t origin = geo.index(r0, c0);
 
-    if (radarDirection < 1 || radarDirection > 8) {
-        return results;
+    if (radarDirection == 0) {
+        for (int d : BoardGeometry::around) {
+            addCell(d == 0 ? BoardGeometry::offBoard : geo.next(origin, d));
+        }
+        return;
     }
 
     int dr = directions[radarDirection].first;
     int dc = directions[radarDirection].second;
 
-    int pr = -dc;
-    int pc = dr;
+    if (dr == 0 || dc == 0) {
+        fillAxisRay(ray, r0, c0, dr, dc);
+        return;
+    }
+
+    int     left  = BoardGeometry::perpendicular(radarDirection);
+    int     right = BoardGeometry::opposite(left);
+    int32_t step  = geo.offset(radarDirection);
+    int32_t steps = geo.reach(origin, radarDirection);
+
+    for (int32_t k = 0, cell = origin + step; k < steps; ++k, cell += step) {
+        addCell(cell);
+        addCell(geo.next(cell, left));
+        addCell(geo.next(cell, right));
+    }
+}
+
+// Up, down, left and right rays run along rows of m_board or columns of
+// m_boardByCol, so each of the three lanes is a contiguous run of bytes.
+// BoardScan classifies up to 64 steps of a lane at once and terrain is
+// only read where its mask has a bit set.
+void Arena::fillAxisRay(RadarRay& ray, int r0, int c0, int dr, int dc) const {
+    bool horizontal = (dr == 0);
+    int  step       = horizontal ? dc : dr;        // +1 or -1 along the lane
+    int  along      = horizontal ? c0 : r0;
+    int  length     = horizontal ? m_cols : m_rows;
+    int  perp       = horizontal ? -dc : dr;       // where the +perpendicular lane is
+
+    int32_t origin    = m_geometry.index(r0, c0);
+    int     direction = BoardGeometry::direction(dr, dc);
+    int     left      = BoardGeometry::perpendicular(direction);
+    int     steps     = m_geometry.reach(origin, direction);
+
+    const char* plane = horizontal ? m_board.data() : m_boardByCol.data();
+
+    int  across   = horizontal ? r0 : c0;
+    const int lane[3] = {across, across + perp, across - perp};
+    const bool onBoard[3] = {true,
+                             m_geometry.next(origin, left) != BoardGeometry::offBoard,
+                             m_geometry.next(origin, BoardGeometry::opposite(left)) !=
+                                 BoardGeometry::offBoard};
+
+    for (int base = 0; base < steps; base += 64) {
+        int n     = std::min(64, steps - base);
+        int first = step > 0 ? along + 1 + base : along - base - n;
+
+        uint64_t mask[3] = {};
+        for (int l = 0; l < 3; ++l) {
+            if (onBoard[l]) {
+                mask[l] = BoardScan::scan(plane + lane[l] * length + first, n, '.');
+            }
+        }
 
-    int curRow = r0 + dr;
-    int curCol = c0 + dc;
+        for (int j = 0; j < n; ++j) {
+            int k   = base + 1 + j;
+            int bit = step > 0 ? j : n - 1 - j;
 
-    while (inBounds(curRow, curCol)) {
-        addCell(curRow, curCol);
-        addCell(curRow + pr, curCol + pc);
-        addCell(curRow - pr, curCol - pc);
+            for (int l = 0; l < 3; ++l) {
+                if (!onBoard[l]) {
+                    ray.index.push_back(-1);
+                    continue;
+                }
+                int  r  = horizontal ? lane[l] : r0 + k * dr;
+                int  c  = horizontal ? c0 + k * dc : lane[l];
+                char ch = ((mask[l] >> bit) & 1) ? plane[lane[l] * length + first + bit] : '.';
 
-        curRow += dr;
-        curCol += dc;
+                ray.index.push_back(static_cast<int32_t>(ray.cells.size()));
+                ray.cells.emplace_back(ch, r, c);
+            }
+        }
     }
+}
+
+int Arena::RadarRay::find(int direction, int dRow, int dCol) const {
+    if (direction == 0) {
+        if (dRow < -1 || dRow > 1 || dCol < -1 || dCol > 1) return -1;
+        return index[(dRow + 1) * 3 + (dCol + 1)];
+    }
+
+    // Solve (dRow, dCol) = step * (dr, dc) + lane * (-dc, dr); the two
+    // vectors are orthogonal, so each cell has at most one (step, lane).
+    int dr   = directions[direction].first;
+    int dc   = directions[direction].second;
+    int norm = dr * dr + dc * dc;
 
-    return results;
+    int stepN = dRow * dr + dCol * dc;
+    int laneN = dCol * dr - dRow * dc;
+    if (stepN % norm != 0 || laneN % norm != 0) return -1;
+
+    int step = stepN / norm;
+    int lane = laneN / norm;
+    if (step < 1 || lane < -1 || lane > 1) return -1;
+
+    size_t slot = static_cast<size_t>(step - 1) * 3 + (lane == 0 ? 0 : lane == 1 ? 1 : 2);
+    return slot < index.size() ? index[slot] : -1;
 }
 
 void Arena::handleMovement(RobotInfo& info, int moveDirection, int distance) {
+    TRACE_ROBOT_SCOPE("handleMovement", slotOf(info));
+
     if (info.inPit || info.robot->get_move_speed() == 0) {
-        std::cout << "  " << info.name << " is stuck and cannot move.\n";
+        log() << "  " << info.name << " is stuck and cannot move.\n";
         return;
     }
 
     if (moveDirection < 1 || moveDirection > 8) {
-        std::cout << "  " << info.name << " is not moving.\n";
+        log() << "  " << info.name << " is not moving.\n";
         return;
     }
 
@@ -406,7 +1090,7 @@ void Arena::handleMovement(RobotInfo& info, int moveDirection, int distance) {
         distance = maxSpeed;
     }
     if (distance <= 0) {
-        std::cout << "  " << info.name << " is not moving.\n";
+        log() << "  " << info.name << " is not moving.\n";
         return;
     }
 
@@ -419,52 +1103,47 @@ void Arena::handleMovement(RobotInfo& info, int moveDirection, int distance) {
     int startRow = curRow;
     int startCol = curCol;
 
+    // the edge stops the walk as a mound would
+    int32_t at = m_geometry.index(curRow, curCol);
+    distance   = std::min(distance, m_geometry.reach(at, moveDirection));
+
     for (int step = 0; step < distance; ++step) {
         int nextRow = curRow + dr;
         int nextCol = curCol + dc;
+        at += m_geometry.offset(moveDirection);
 
-        if (!inBounds(nextRow, nextCol)) {
-            break;
-        }
-
-        bool blockedByRobot = false;
-        for (const auto& other : m_robots) {
-            if (&other == &info) continue;
-            if (other.row == nextRow && other.col == nextCol) {
-                blockedByRobot = true;
-                break;
-            }
-        }
-        if (blockedByRobot) {
-            break;
+        if (m_robotAtCell[at] >= 0) {
+            break;   // blocked by a robot or a wreck
         }
 
-        char cell = m_board[nextRow][nextCol];
+        char cell = m_board[at];
 
         if (cell == 'M') {
             break;
         } else if (cell == 'P') {
             curRow = nextRow;
             curCol = nextCol;
-            info.row = curRow;
-            info.col = curCol;
-            info.robot->move_to(curRow, curCol);
+            moveRobot(info, curRow, curCol);
 
             info.inPit = true;
             info.robot->disable_movement();
+            ++info.stats.moves;
+            ++info.stats.pitEvents;
+            recordEvent(ArenaEvent::Pit, info, curRow, curCol);
 
-            std::cout << "  " << info.name << " falls into a pit at ("
+            log() << "  " << info.name << " falls into a pit at ("
                       << curRow << "," << curCol << ").\n";
             break;
         } else if (cell == 'F') {
             curRow = nextRow;
             curCol = nextCol;
-            info.row = curRow;
-            info.col = curCol;
-            info.robot->move_to(curRow, curCol);
+            moveRobot(info, curRow, curCol);
 
-            std::cout << "  " << info.name << " moves through a flame trap at ("
+            log() << "  " << info.name << " moves through a flame trap at ("
                       << curRow << "," << curCol << ").\n";
+            ++info.stats.moves;
+            ++info.stats.flameEvents;
+            recordEvent(ArenaEvent::FlameTrap, info, curRow, curCol);
             applyFlameTrapDamage(info);
 
             if (!info.alive || info.robot->get_health() <= 0) {
@@ -473,72 +1152,134 @@ void Arena::handleMovement(RobotInfo& info, int moveDirection, int distance) {
         } else {
             curRow = nextRow;
             curCol = nextCol;
-            info.row = curRow;
-            info.col = curCol;
-            info.robot->move_to(curRow, curCol);
+            moveRobot(info, curRow, curCol);
+            ++info.stats.moves;
         }
     }
 
     if (startRow != curRow || startCol != curCol) {
-        std::cout << "  Moving: " << info.name << " moves to ("
+        recordEvent(ArenaEvent::Moved, info, curRow, curCol);
+        log() << "  Moving: " << info.name << " moves to ("
                   << curRow << "," << curCol << ").\n";
     } else {
-        std::cout << "  " << info.name << " stays at ("
+        log() << "  " << info.name << " stays at ("
                   << curRow << "," << curCol << ").\n";
     }
 }
 
+void Arena::moveRobot(RobotInfo& info, int row, int col) {
+    countLive(info, -1);
+    m_robotAtCell[info.row * m_cols + info.col] = -1;
+    m_robotAtCell[row * m_cols + col]           = slotOf(info);
+    info.row = row;
+    info.col = col;
+    info.robot->move_to(row, col);
+    countLive(info, +1);
+}
+
+void Arena::countLive(const RobotInfo& info, int delta) {
+    if (!info.alive) return;
+
+    m_liveInRow[info.row]                          += delta;
+    m_liveInCol[info.col]                          += delta;
+    m_liveInDiag[info.row - info.col + m_cols - 1] += delta;
+    m_liveInAnti[info.row + info.col]              += delta;
+}
+
+int Arena::liveOnLine(int row, int col, int dr, int dc) const {
+    if (dr == 0)  return m_liveInRow[row];
+    if (dc == 0)  return m_liveInCol[col];
+    if (dr == dc) return m_liveInDiag[row - col + m_cols - 1];
+    return m_liveInAnti[row + col];
+}
+
 void Arena::applyFlameTrapDamage(RobotInfo& target) {
     applyWeaponDamage(target, flamethrower);
 }
 
 void Arena::handleShot(RobotInfo& shooter, int shotRow, int shotCol) {
+    TRACE_ROBOT_SCOPE("handleShot", slotOf(shooter));
+
     WeaponType weapon = shooter.robot->get_weapon();
 
     if (weapon == grenade) {
         if (shooter.robot->get_grenades() <= 0) {
-            std::cout << "  " << shooter.name << " is out of grenades.\n";
+            log() << "  " << shooter.name << " is out of grenades.\n";
             return;
         }
         shooter.robot->decrement_grenades();
     }
 
+    ++shooter.stats.shots;
+    recordEvent(ArenaEvent::Shot, shooter, shotRow, shotCol, weapon);
+
     int sr = shooter.row;
     int sc = shooter.col;
 
-    auto damageAtCell = [&](int r, int c) {
-        if (!inBounds(r, c)) return;
-        for (auto& target : m_robots) {
-            if (!target.alive || target.robot->get_health() <= 0) continue;
-            if (target.row == r && target.col == c) {
-                applyWeaponDamage(target, weapon);
-            }
-        }
+    const BoardGeometry& geo = m_geometry;
+    auto damageAtCell = [&](int32_t cell) {
+        if (cell == BoardGeometry::offBoard) return;
+        int slot = m_robotAtCell[cell];
+        if (slot < 0 || !isAlive(m_robots[slot])) return;
+        shooter.stats.damageDealt +=
+            applyWeaponDamage(m_robots[slot], weapon, slotOf(shooter));
     };
 
-    int dr = shotRow - sr;
-    int dc = shotCol - sc;
-    int dirIndex = directionFromDelta(dr, dc);
+    int32_t origin   = geo.index(sr, sc);
+    int     dirIndex = BoardGeometry::direction(shotRow - sr, shotCol - sc);
 
     switch (weapon) {
     case railgun:
     {
         if (dirIndex == 0) {
-            std::cout << "  " << shooter.name << " fires railgun but direction is invalid.\n";
+            log() << "  " << shooter.name << " fires railgun but direction is invalid.\n";
             return;
         }
 
         int stepR = directions[dirIndex].first;
         int stepC = directions[dirIndex].second;
 
-        std::cout << "  Shooting: railgun\n";
+        log() << "  Shooting: railgun\n";
 
-        int r = sr + stepR;
-        int c = sc + stepC;
-        while (inBounds(r, c)) {
-            damageAtCell(r, c);
-            r += stepR;
-            c += stepC;
+        // The shooter is one of the live robots on its own line; if it is
+        // the only one there is nothing to hit.
+        if (liveOnLine(sr, sc, stepR, stepC) <= 1) {
+            break;
+        }
+
+        // Otherwise hit only the robots ahead on the line, nearest first,
+        // in the same order as a walk from the shooter to the edge. Pick
+        // whichever is shorter: the roster, or the cells of the line.
+        m_lineHits.clear();
+        if (m_robots.size() <= static_cast<size_t>(std::max(m_rows, m_cols))) {
+            for (size_t i = 0; i < m_robots.size(); ++i) {
+                const RobotInfo& target = m_robots[i];
+                if (!target.alive || target.robot->get_health() <= 0) continue;
+
+                int dRow = target.row - sr;
+                int dCol = target.col - sc;
+                int k    = std::max(std::abs(dRow), std::abs(dCol));
+                if (k > 0 && dRow == k * stepR && dCol == k * stepC) {
+                    m_lineHits.emplace_back(k, static_cast<int>(i));
+                }
+            }
+            std::sort(m_lineHits.begin(), m_lineHits.end());
+        } else {
+            int32_t step  = geo.offset(dirIndex);
+            int32_t steps = geo.reach(origin, dirIndex);
+            int32_t cell  = origin;
+            for (int k = 1; k <= steps; ++k) {
+                cell += step;
+                int slot = m_robotAtCell[cell];
+                if (slot >= 0) m_lineHits.emplace_back(k, slot);
+            }
+        }
+
+        for (const auto& [distance, slot] : m_lineHits) {
+            RobotInfo& target = m_robots[slot];
+            if (!target.alive || target.robot->get_health() <= 0) continue;
+            shooter.stats.damageDealt +=
+                applyWeaponDamage(target, weapon, slotOf(shooter));
         }
         break;
     }
@@ -546,44 +1287,35 @@ void Arena::handleShot(RobotInfo& shooter, int shotRow, int shotCol) {
     case hammer:
     {
         if (dirIndex == 0) {
-            std::cout << "  " << shooter.name << " swings hammer but hits nothing.\n";
+            log() << "  " << shooter.name << " swings hammer but hits nothing.\n";
             return;
         }
 
-        int stepR = directions[dirIndex].first;
-        int stepC = directions[dirIndex].second;
-
-        int r = sr + stepR;
-        int c = sc + stepC;
-
-        std::cout << "  Shooting: hammer\n";
-        damageAtCell(r, c);
+        log() << "  Shooting: hammer\n";
+        damageAtCell(geo.next(origin, dirIndex));
         break;
     }
 
     case flamethrower:
     {
         if (dirIndex == 0) {
-            std::cout << "  " << shooter.name << " fires flamethrower blindly.\n";
+            log() << "  " << shooter.name << " fires flamethrower blindly.\n";
             return;
         }
 
-        int stepR = directions[dirIndex].first;
-        int stepC = directions[dirIndex].second;
-
-        int pr = -stepC;
-        int pc = stepR;
+        int     left  = BoardGeometry::perpendicular(dirIndex);
+        int     right = BoardGeometry::opposite(left);
+        int32_t step  = geo.offset(dirIndex);
+        int32_t steps = std::min(4, geo.reach(origin, dirIndex));
 
-        std::cout << "  Shooting: flamethrower\n";
+        log() << "  Shooting: flamethrower\n";
 
-        for (int k = 1; k <= 4; ++k) {
-            int centerR = sr + stepR * k;
-            int centerC = sc + stepC * k;
-            if (!inBounds(centerR, centerC)) break;
-
-            damageAtCell(centerR, centerC);
-            damageAtCell(centerR + pr, centerC + pc);
-            damageAtCell(centerR - pr, centerC - pc);
+        int32_t center = origin;
+        for (int k = 1; k <= steps; ++k) {
+            center += step;
+            damageAtCell(center);
+            damageAtCell(geo.next(center, left));
+            damageAtCell(geo.next(center, right));
         }
         break;
     }
@@ -591,26 +1323,25 @@ void Arena::handleShot(RobotInfo& shooter, int shotRow, int shotCol) {
     case grenade:
     {
         if (!inBounds(shotRow, shotCol)) {
-            std::cout << "  " << shooter.name << " throws grenade off the board.\n";
+            log() << "  " << shooter.name << " throws grenade off the board.\n";
             return;
         }
 
-        std::cout << "  Shooting: grenade at (" << shotRow << "," << shotCol << ")\n";
+        log() << "  Shooting: grenade at (" << shotRow << "," << shotCol << ")\n";
 
-        for (int r = shotRow - 1; r <= shotRow + 1; ++r) {
-            for (int c = shotCol - 1; c <= shotCol + 1; ++c) {
-                damageAtCell(r, c);
-            }
+        int32_t center = geo.index(shotRow, shotCol);
+        for (int d : BoardGeometry::around) {
+            damageAtCell(d == 0 ? center : geo.next(center, d));
         }
         break;
     }
     }
 }
 
-void Arena::applyWeaponDamage(RobotInfo& target, WeaponType weapon) {
-    if (!target.alive) return;
+int Arena::applyWeaponDamage(RobotInfo& target, WeaponType weapon, int attacker) {
+    if (!target.alive) return 0;
 
-    std::mt19937 rng(std::random_device{}());
+    auto& rng = target.damageRng;
     int minD = 0;
     int maxD = 0;
 
@@ -638,11 +1369,18 @@ void Arena::applyWeaponDamage(RobotInfo& target, WeaponType weapon) {
     }
 
     int newHealth = target.robot->take_damage(finalDamage);
-    std::cout << "  " << target.name << " takes "
+    target.stats.damageTaken += finalDamage;
+    recordEvent(ArenaEvent::Damage, target, target.row, target.col,
+                finalDamage, attacker);
+    log() << "  " << target.name << " takes "
               << finalDamage << " damage. Health: " << newHealth << "\n";
 
     if (newHealth <= 0) {
+        countLive(target, -1);
         target.alive = false;
-        std::cout << "  " << target.name << " is out!\n";
+        --m_aliveCount;
+        recordEvent(ArenaEvent::Death, target, target.row, target.col);
+        log() << "  " << target.name << " is out!\n";
     }
+    return finalDamage;
 }
@@ -4,36 +4,236 @@
 #include <string>
 #include <string_view>
 #include <memory>
+#include <random>
+#include <cstdint>
+#include <ostream>
+#include <optional>
+#include <chrono>
 
 #include "RobotBase.h"
 #include "RadarObj.h"
+#include "ResultsStore.h"
+#include "PerfCounters.h"
+#include "RobotRegistry.h"
+#include "MapPack.h"
+#include "SpectatorFeed.h"
+#include "Replay.h"
+#include "TurnPipeline.h"
+#include "AllocHooks.h"
+#include "BoardGeometry.h"
 
+// Running totals for one robot over the current match.
+struct RobotStats {
+    int damageDealt = 0;
+    int damageTaken = 0;
+    int shots       = 0;
+    int moves       = 0;   // cells moved
+    int pitEvents   = 0;
+    int flameEvents = 0;
+};
+
+// One roster slot. The robot is owned here and deleted before the library
+// reference is released (members are destroyed in reverse order).
 struct RobotInfo {
-    RobotBase* robot   = nullptr;
-    void*      soHandle = nullptr;
+    std::shared_ptr<RobotLibrary> library;
+    std::unique_ptr<RobotBase> robot;
+    AsyncRobot*  async    = nullptr;   // robot, if it answers asynchronously
+    RobotFactory factory  = nullptr;
+    std::string  source;   // "Robot_Ratboy"
 
     std::string name;
-    char symbol = '?';
+    uint32_t id     = 0;     // index in robots(): unique, unlike the glyph
+    char     symbol = '?';   // board glyph; repeats past 9 robots
 
     int row = 0;
     int col = 0;
 
     bool alive = true;
     bool inPit = false;
+
+    RobotStats stats;
+
+    // Heap the robot holds, charged while it constructs and while its
+    // callbacks run; reset with the robot each match.
+    HeapAccount heap;
+
+    // Damage rolls against this robot come from its own stream, so a
+    // given seed yields the same rolls no matter who shoots first.
+    std::mt19937 damageRng;
+};
+
+// Everything needed to set up an arena without a config file.
+struct ArenaConfig {
+    int  rows       = 20;
+    int  cols       = 20;
+    int  numMounds  = 5;
+    int  numPits    = 3;
+    int  numFlamers = 3;
+    int  maxRounds  = 200;
+    bool watchLive  = true;   // print the board and turn log, sleep between rounds
+
+    // Unset means a fresh random seed.
+    std::optional<uint32_t> seed;
+
+    // Play the maps of this pack (map seed % size, with its spawn points)
+    // instead of scattering obstacles each match. Must match rows x cols.
+    std::shared_ptr<const MapPack> maps;
+
+    // A robot holding more heap than this (kB) after one of its callbacks
+    // forfeits: it is out, as if destroyed. 0 means no cap.
+    uint32_t heapCapKb = 0;
+};
+
+// Something that happened during a turn, for callers that drive the arena
+// with step() instead of reading the printed log. Recorded only after
+// setEventRecording(true).
+struct ArenaEvent {
+    enum Type {
+        Shot,        // robot fired weapon (value) toward row,col
+        Damage,      // robot took value damage from other (-1: flame trap)
+        Moved,       // robot ended its move at row,col
+        Pit,         // robot fell into the pit at row,col
+        FlameTrap,   // robot moved through the flame trap at row,col
+        Death        // robot is out
+    };
+
+    Type type;
+    int  round;
+    int  robot;
+    int  other = -1;
+    int  row   = -1;
+    int  col   = -1;
+    int  value = 0;
+};
+
+// Read-only snapshot of a robot for embedding code.
+struct RobotState {
+    std::string name;
+    uint32_t   id;
+    char       symbol;
+    int        row;
+    int        col;
+    int        health;
+    int        armor;
+    int        moveSpeed;
+    WeaponType weapon;
+    int        grenades;
+    bool       alive;
+    bool       inPit;
 };
 
 class Arena {
 public:
+    explicit Arena(const ArenaConfig& config);
+
     Arena(int rows, int cols);
 
+    // Seeded arena: the map, spawn positions and damage rolls are all
+    // derived from seed, so two runs with the same seed are paired.
+    Arena(int rows, int cols, uint32_t seed);
+
     // Load configuration (arena size, obstacles, max rounds, watchLive)
     void loadConfig(const std::string& filename);
 
-    // Compile & load Robot_*.cpp files, create RobotBase instances
+    // Compile & load Robot_*.cpp files, create RobotBase instances.
+    // In the static build the robots come from registeredRobots() instead.
     void loadRobots();
 
-    // Run the simulation until winner or max rounds
-    void run();
+    // Add one robot from its factory (e.g. one linked into the caller).
+    // source identifies it in error messages. Robots are placed when the
+    // match starts.
+    bool addRobot(RobotFactory factory, const std::string& source = "");
+    bool addRobot(const RegisteredRobot& robot);
+    // Swap the robot built from robot.source for a new build of it, e.g.
+    // a reloaded library. Only allowed between matches or before the first
+    // turn; the next newMatch() plays the new version. Returns false if
+    // nothing changed.
+    bool replaceRobot(const RegisteredRobot& robot);
+
+    // Start a fresh match on the same roster: new map, new robot
+    // instances and spawn positions, all drawn from seed. A robot whose
+    // factory throws or returns nullptr is out of this match from the
+    // start.
+    void newMatch(uint32_t seed);
+
+    // Run the simulation until winner or max rounds.
+    // Returns the winner's index into robots(), or -1 for a draw.
+    int run();
+
+    // Stepping API: play one robot turn, or the rest of the current round.
+    // Both return false once the match is over (a winner or max rounds).
+    bool step();
+    bool stepRound();
+    bool matchOver() const;
+
+    // The same as coroutines (see TurnPipeline.h): one turn, the rest of
+    // the round, or the rest of the match. They only suspend while an
+    // AsyncRobot is thinking, so a TurnScheduler can run other arenas'
+    // turns in the meantime; step() is playTurn().wait(). playRound and
+    // playMatch start the match if needed and do nothing once it is over.
+    Task playTurn();
+    Task playRound();
+    Task playMatch();
+
+    // When stepping by hand: call once the match is over to settle the
+    // winner and wall time for matchRecord(). Returns the winner index.
+    int finishMatch();
+
+    // Winner index once the match is over (-1: draw or still running).
+    int winner() const { return matchOver() ? getWinnerIndex() : -1; }
+
+    // Board queries. cellAt returns the terrain ('.', 'M', 'P', 'F');
+    // robotAt returns the index of the robot standing at r,c or -1, in
+    // O(1) from the cell index.
+    int  rows() const { return m_rows; }
+    int  cols() const { return m_cols; }
+    char cellAt(int r, int c) const;
+    int  robotAt(int r, int c) const;
+
+    size_t     robotCount() const { return m_robots.size(); }
+    int        aliveRobots() const { return m_aliveCount; }
+
+    // "Name glyph" while every robot has its own glyph, "Name #id" once
+    // there are more robots than glyphs.
+    std::string label(const RobotInfo& info) const;
+
+    // Source name, factory and library of every loaded robot, in slot
+    // order, so other arenas can be built with the same roster.
+    std::vector<RegisteredRobot> roster() const;
+    RobotState robotState(size_t index) const;
+
+    // Events since the last clearEvents() (or match start).
+    void setEventRecording(bool record) { m_recordEvents = record; }
+    const std::vector<ArenaEvent>& events() const { return m_events; }
+    void clearEvents() { m_events.clear(); }
+
+    void setWatchLive(bool watchLive) { m_watchLive = watchLive; }
+
+    uint32_t seed() const { return m_seed; }
+    int roundsPlayed() const { return m_roundsPlayed; }
+    const std::vector<RobotInfo>& robots() const { return m_robots; }
+
+    // Hash of the rules that shape a match (size, obstacles, max rounds),
+    // so results from different configurations aren't mixed up.
+    uint64_t configHash() const;
+
+    // Fixed-schema summary of the match run() just finished.
+    MatchRecord matchRecord() const;
+
+    // Count cycles, instructions, cache and branch misses around each
+    // phase of a robot turn, per robot. Returns false (and stays off) when no
+    // counter can be opened, e.g. inside a container.
+    bool enablePerfCounters();
+    void printPerfReport(std::ostream& out) const;
+
+    // Publish a frame per turn (and a key frame per match) to shared
+    // memory feed "name" for rwspectate viewers. Call after the robots
+    // are loaded; throws if the feed can't be created.
+    void enableSpectatorFeed(const std::string& name);
+
+    // Record the same frames to replay file path for rwspectate --replay.
+    // Call after the robots are loaded; throws if path can't be created.
+    void enableReplay(const std::string& path);
 
 private:
     int m_rows;
@@ -45,11 +245,87 @@ private:
     int  m_numFlamers = 3;
     int  m_maxRounds  = 200;
     bool m_watchLive  = true;
+    uint32_t m_heapCapKb = 0;
+
+    // Common-random-numbers support: every random draw comes from a
+    // stream derived from m_seed (see seedStreams()).
+    uint32_t     m_seed = 0;
+    std::mt19937 m_mapRng;
+    std::mt19937 m_spawnRng;
+    int          m_roundsPlayed = 0;
+    int          m_winner       = -1;
+    uint64_t     m_wallNanos    = 0;
+    std::chrono::steady_clock::time_point m_matchStart;
+
+    // Stepping state: the slots still alive at the start of this round in
+    // turn order (the dead are dropped as the round ends), the next one
+    // to act, and whether the robots have been placed for this match.
+    std::vector<int32_t> m_turnOrder;
+    size_t m_turnCursor = 0;
+    bool   m_started    = false;
+    int    m_aliveCount = 0;
+
+    bool                    m_recordEvents = false;
+    std::vector<ArenaEvent> m_events;
+
+    // Optional hardware counters (see enablePerfCounters())
+    std::unique_ptr<PerfCounters> m_perf;
+    PerfReport                    m_perfReport;
+
+    // Optional live feed and replay file (see enableSpectatorFeed() and
+    // enableReplay())
+    std::unique_ptr<SpectatorFeed> m_feed;
+    std::unique_ptr<ReplayWriter>  m_replay;
+    uint64_t                       m_feedMatch = 0;
+    std::vector<FeedRobot>         m_feedRobots;
+    std::vector<char>              m_feedNames;
+
+    std::shared_ptr<const MapPack> m_maps;
+
+    std::vector<char>      m_board;        // terrain, row-major
+    BoardGeometry          m_geometry;     // neighbor tables for m_board's cells
+    std::vector<char>      m_boardByCol;   // the same, column-major
+    std::vector<RobotInfo> m_robots;
+    std::vector<RadarObj>  m_radarResults;
+
+    // Radar rays over the static terrain, cached per (cell, direction 0-8)
+    // and filled on first use. Bumping m_terrainGeneration (whenever the
+    // board's M/P/F layout changes) invalidates every entry at once;
+    // robots are overlaid on each scan since they move every turn.
+    struct RadarRay {
+        uint32_t              generation = 0;
+        std::vector<RadarObj> cells;   // terrain in scan order
+        std::vector<int32_t>  index;   // (step, lane) -> position in cells or -1
+
+        int find(int direction, int dRow, int dCol) const;
+    };
+    uint32_t                                         m_terrainGeneration = 0;
+    mutable std::vector<std::unique_ptr<RadarRay[]>> m_radarCache;   // 9 per cell
+
+    // Large boards would fill gigabytes of rays; past this many bytes,
+    // cells without cached rays scan into m_radarScratch instead.
+    static constexpr size_t radarCacheBudget = size_t(64) << 20;
+    mutable size_t          m_radarCacheBytes = 0;
+    mutable RadarRay        m_radarScratch;
+
+    // Slot of the robot on each cell (row-major), or -1. Wrecks stay on
+    // their cell and still block it, so at most one robot is ever there;
+    // every per-cell robot query goes through this instead of the roster.
+    std::vector<int32_t> m_robotAtCell;
 
-    std::vector<std::vector<char>> m_board;
-    std::vector<RobotInfo>         m_robots;
+    // Live robots on each row, column, diagonal (r - c) and anti-diagonal
+    // (r + c), kept current as robots are placed, move and die, so a shot
+    // along a line knows at once whether there is anything to hit.
+    std::vector<int>                 m_liveInRow;
+    std::vector<int>                 m_liveInCol;
+    std::vector<int>                 m_liveInDiag;
+    std::vector<int>                 m_liveInAnti;
+    std::vector<std::pair<int, int>> m_lineHits;   // (distance, slot) scratch
 
     // Setup helpers
+    bool addRobot(const RegisteredRobot& robot, size_t slot);
+    void seedStreams();
+    void startMatch();
     void initBoard();
     void placeObstacles();
     void placeRobotsRandomly();
@@ -58,23 +334,43 @@ private:
     void printBoard(int round) const;
     void printRobotStatus(const RobotInfo& info) const;
 
-    void runRound(int round);
-    void handleRobotTurn(RobotInfo& info);
+    void perfCharge(PerfReport::Phase phase, int slot, PerfCounters::Sample& mark);
+    void publishFrame(int turn);
+    bool forfeitOverHeapCap(RobotInfo& info);
+    Task robotTurn(RobotInfo& info);
+    RobotReply robotCall(RobotInfo& info, AsyncRobot::Call call,
+                         const std::vector<RadarObj>* radar = nullptr);
+    void endRound();
+    void recordEvent(ArenaEvent::Type type, const RobotInfo& info,
+                     int row = -1, int col = -1, int value = 0, int other = -1);
 
+    bool isAlive(const RobotInfo& info) const;
     bool isGameOver() const;
     int  countAliveRobots() const;
     int  getWinnerIndex() const;
 
     // Radar / movement / shooting
-    std::vector<RadarObj> makeRadar(const RobotInfo& info, int radarDirection) const;
+    // Fills results (cleared first) so the buffer is reused every turn.
+    void makeRadar(const RobotInfo& info, int radarDirection,
+                   std::vector<RadarObj>& results) const;
+    const RadarRay& radarRay(int row, int col, int radarDirection) const;
+    void fillRadarRay(RadarRay& ray, int row, int col, int radarDirection) const;
+    void fillAxisRay(RadarRay& ray, int row, int col, int dr, int dc) const;
 
     void handleShot(RobotInfo& shooter, int shotRow, int shotCol);
     void handleMovement(RobotInfo& info, int moveDirection, int distance);
+    void moveRobot(RobotInfo& info, int row, int col);
+    void countLive(const RobotInfo& info, int delta);
+    int  liveOnLine(int row, int col, int dr, int dc) const;
 
-    void applyWeaponDamage(RobotInfo& target, WeaponType weapon);
+    // Returns the damage actually dealt after armor. attacker is the
+    // shooter's slot, or -1 for a flame trap.
+    int  applyWeaponDamage(RobotInfo& target, WeaponType weapon, int attacker = -1);
     void applyFlameTrapDamage(RobotInfo& target);
 
     // Utilities
+    std::ostream& log() const;
+    int  slotOf(const RobotInfo& info) const;
     bool inBounds(int r, int c) const;
     bool cellHasRobot(int r, int c, int& robotIndexOut) const;
 
@@ -0,0 +1,130 @@
+#include "BatchRunner.h"
+#include "RobotWatcher.h"
+#include "TurnPipeline.h"
+
+#include <algorithm>
+#include <thread>
+
+BatchRunner::BatchRunner(std::vector<RegisteredRobot> roster, const BatchOptions& options)
+    : m_roster(std::move(roster)),
+      m_options(options)
+{
+    m_options.config.watchLive = false;
+    m_options.threads    = std::max(1, m_options.threads);
+    m_options.batchWidth = std::max(1, m_options.batchWidth);
+}
+
+void BatchRunner::run(const std::function<void(const MatchRecord&)>& onResult)
+{
+    m_nextMatch = 0;
+    m_error     = nullptr;
+
+    // an exception escaping a std::thread would terminate the process
+    auto guarded = [this, &onResult] {
+        try {
+            runThread(onResult);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(m_resultMutex);
+            if (!m_error) m_error = std::current_exception();
+            m_nextMatch = m_options.matches;   // the other threads wind down
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 1; t < m_options.threads; ++t) {
+        workers.emplace_back(guarded);
+    }
+    guarded();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (m_error) {
+        std::rethrow_exception(m_error);
+    }
+}
+
+bool BatchRunner::nextSeed(uint32_t& seed)
+{
+    uint64_t index = m_nextMatch.fetch_add(1, std::memory_order_relaxed);
+    if (index >= m_options.matches) {
+        return false;
+    }
+    seed = m_options.firstSeed + static_cast<uint32_t>(index);
+    return true;
+}
+
+void BatchRunner::runThread(const std::function<void(const MatchRecord&)>& onResult)
+{
+    // Arenas (and their memory) are built once per thread and reused for
+    // every match this thread plays.
+    std::vector<Arena>    lanes;
+    std::vector<bool>     busy;
+    std::vector<uint64_t> builds;   // watcher generation each lane plays
+    lanes.reserve(m_options.batchWidth);
+
+    const RobotWatcher* watcher = m_options.watcher;
+    uint64_t                     generation = 0;
+    std::vector<RegisteredRobot> roster = watcher ? watcher->roster(&generation) : m_roster;
+
+    for (int i = 0; i < m_options.batchWidth; ++i) {
+        uint32_t seed;
+        if (!nextSeed(seed)) break;
+
+        lanes.emplace_back(m_options.config);
+        for (const auto& robot : roster) {
+            lanes.back().addRobot(robot);
+        }
+        lanes.back().newMatch(seed);
+        busy.push_back(true);
+        builds.push_back(generation);
+    }
+
+    std::vector<MatchRecord> finished;
+    size_t active = lanes.size();
+
+    // One round of lane i; if that ends its match, collect the record and
+    // start the lane's next match right away.
+    auto playLane = [&](size_t i) -> Task {
+        co_await lanes[i].playRound();
+        if (!lanes[i].matchOver()) co_return;
+
+        lanes[i].finishMatch();
+        finished.push_back(lanes[i].matchRecord());
+
+        uint32_t seed;
+        if (nextSeed(seed)) {
+            if (watcher && watcher->generation() != builds[i]) {
+                roster = watcher->roster(&generation);
+                for (const auto& robot : roster) {
+                    lanes[i].replaceRobot(robot);
+                }
+                builds[i] = generation;
+            }
+            lanes[i].newMatch(seed);
+        } else {
+            busy[i] = false;
+            --active;
+        }
+    };
+
+    TurnScheduler scheduler;
+    while (active > 0) {
+        // A round on every live arena. They run one after another unless
+        // a robot answers asynchronously; then the other lanes play on
+        // while it thinks.
+        for (size_t i = 0; i < lanes.size(); ++i) {
+            if (busy[i]) scheduler.spawn(playLane(i));
+        }
+        scheduler.run();
+
+        if (!finished.empty()) {
+            std::lock_guard<std::mutex> lock(m_resultMutex);
+            for (const auto& record : finished) {
+                onResult(record);
+            }
+            finished.clear();
+        }
+    }
+}
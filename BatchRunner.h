@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "Arena.h"
+#include "RobotRegistry.h"
+#include "ResultsStore.h"
+
+class RobotWatcher;
+
+struct BatchOptions {
+    ArenaConfig config;            // watchLive is forced off
+    uint32_t    firstSeed  = 0;    // matches use firstSeed, firstSeed+1, ...
+    uint64_t    matches    = 0;
+    int         threads    = 1;
+    int         batchWidth = 16;   // arenas advanced in lockstep per thread
+
+    // If set, an arena picks up robots rebuilt by the watcher when it
+    // starts its next match; matches already running are left alone.
+    const RobotWatcher* watcher = nullptr;
+};
+
+// Plays many matches of one roster across worker threads.
+//
+// Small boards finish a match in microseconds, so per-match setup would
+// dominate. Each thread therefore owns batchWidth arenas that live for the
+// whole run: it advances all of them one round at a time, and when one
+// finishes it is reset in place with newMatch() - board, robot table and
+// radar buffers keep their memory. Only the robots themselves are
+// recreated, through their factories.
+//
+// Note that robots drawing from std::rand() share one process-wide
+// generator, so their choices (and thus results) are only reproducible
+// per seed with threads == 1 and batchWidth == 1.
+class BatchRunner {
+public:
+    BatchRunner(std::vector<RegisteredRobot> roster, const BatchOptions& options);
+
+    // onResult is called once per finished match, never concurrently.
+    // If a thread fails, the others stop drawing seeds and run() rethrows
+    // the first error once they are done.
+    void run(const std::function<void(const MatchRecord&)>& onResult);
+
+private:
+    void runThread(const std::function<void(const MatchRecord&)>& onResult);
+    bool nextSeed(uint32_t& seed);
+
+    std::vector<RegisteredRobot> m_roster;
+    BatchOptions                 m_options;
+
+    std::atomic<uint64_t> m_nextMatch{0};
+    std::mutex            m_resultMutex;
+    std::exception_ptr    m_error;   // first failure, under m_resultMutex
+};
@@ -0,0 +1,36 @@
+#include "BoardGeometry.h"
+#include "RobotBase.h"
+
+#include <algorithm>
+#include <climits>
+
+BoardGeometry::BoardGeometry(int rows, int cols)
+    : m_cols(cols)
+{
+    for (int d = 1; d <= 8; ++d) {
+        m_offset[d] = directions[d].first * cols + directions[d].second;
+    }
+
+    size_t cells = static_cast<size_t>(rows) * cols;
+    m_next.resize(cells * 8);
+    m_reach.resize(cells * 8);
+
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            size_t base = static_cast<size_t>(index(r, c)) * 8;
+            for (int d = 1; d <= 8; ++d) {
+                int dr = directions[d].first;
+                int dc = directions[d].second;
+
+                // a direction that keeps the row (or column) is bounded
+                // by the other one alone
+                int toRow = dr < 0 ? r : dr > 0 ? rows - 1 - r : INT_MAX;
+                int toCol = dc < 0 ? c : dc > 0 ? cols - 1 - c : INT_MAX;
+                int steps = std::min(toRow, toCol);
+
+                m_reach[base + d - 1] = steps;
+                m_next[base + d - 1]  = steps > 0 ? index(r + dr, c + dc) : offBoard;
+            }
+        }
+    }
+}
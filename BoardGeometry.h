@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Neighbor tables for one board size.
+//
+// Cells are row-major indices (r * cols + c). For every cell and each of
+// the 8 directions of RobotBase.h's directions[] (1 Up ... 8 Up-left) the
+// table holds the index of the neighboring cell, or offBoard past the
+// edge, and the number of steps from the cell to the edge. Rays are then
+// walked by index - cell += offset(direction), reach(cell, direction)
+// times, or next() until offBoard - with no bounds checks on the way.
+class BoardGeometry {
+public:
+    static constexpr int32_t offBoard = -1;
+
+    BoardGeometry() = default;
+    BoardGeometry(int rows, int cols);
+
+    int32_t index(int r, int c) const { return r * m_cols + c; }
+    int     row(int32_t cell) const   { return cell / m_cols; }
+    int     col(int32_t cell) const   { return cell % m_cols; }
+
+    // Neighbor of cell in direction 1-8, or offBoard.
+    int32_t next(int32_t cell, int direction) const {
+        return m_next[static_cast<size_t>(cell) * 8 + (direction - 1)];
+    }
+
+    // Steps from cell to the edge in direction 1-8.
+    int32_t reach(int32_t cell, int direction) const {
+        return m_reach[static_cast<size_t>(cell) * 8 + (direction - 1)];
+    }
+
+    // Index difference of one step in direction 1-8.
+    int32_t offset(int direction) const { return m_offset[direction]; }
+
+    // The direction (0-8) of a step by the signs of (dr, dc); 0 for none.
+    static int direction(int dr, int dc) {
+        return towards[(dr > 0) - (dr < 0) + 1][(dc > 0) - (dc < 0) + 1];
+    }
+
+    // The direction of (-dc, dr), a quarter turn from direction (1-8),
+    // and the one facing back.
+    static int perpendicular(int direction) { return (direction + 5) % 8 + 1; }
+    static int opposite(int direction)      { return (direction + 3) % 8 + 1; }
+
+    // The 3x3 block around a cell in row-major order, as directions
+    // (0 is the cell itself).
+    static constexpr int around[9] = {8, 1, 2, 7, 0, 3, 6, 5, 4};
+
+private:
+    static constexpr int towards[3][3] = {{8, 1, 2}, {7, 0, 3}, {6, 5, 4}};
+
+    int                  m_cols = 0;
+    int32_t              m_offset[9] = {};
+    std::vector<int32_t> m_next;    // 8 per cell
+    std::vector<int32_t> m_reach;   // 8 per cell
+};
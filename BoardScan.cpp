@@ -0,0 +1,174 @@
+#include "BoardScan.h"
+
+#include <random>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BOARDSCAN_X86 1
+#endif
+
+namespace BoardScan {
+
+namespace {
+uint64_t scanScalar(const char* cells, int count, char empty)
+{
+    uint64_t mask = 0;
+    for (int i = 0; i < count; ++i) {
+        if (cells[i] != empty) mask |= uint64_t(1) << i;
+    }
+    return mask;
+}
+
+#ifdef BOARDSCAN_X86
+// Full vectors only; the tail (never more than one vector's worth) goes
+// through the scalar loop so we never read past the run.
+uint64_t scanSSE2(const char* cells, int count, char empty)
+{
+    const __m128i blank = _mm_set1_epi8(empty);
+    uint64_t mask = 0;
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cells + i));
+        uint32_t eq = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, blank)));
+        mask |= uint64_t(~eq & 0xFFFFu) << i;
+    }
+    if (i < count) {
+        mask |= scanScalar(cells + i, count - i, empty) << i;
+    }
+    return mask;
+}
+
+__attribute__((target("avx2")))
+uint64_t scanAVX2(const char* cells, int count, char empty)
+{
+    const __m256i blank = _mm256_set1_epi8(empty);
+    uint64_t mask = 0;
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i v  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cells + i));
+        uint32_t eq = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, blank)));
+        mask |= uint64_t(~eq) << i;
+    }
+    if (i < count) {
+        mask |= scanSSE2(cells + i, count - i, empty) << i;
+    }
+    return mask;
+}
+#endif
+
+using ScanFn = uint64_t (*)(const char*, int, char);
+
+ScanFn kernelFn(Kernel kernel)
+{
+    switch (kernel) {
+#ifdef BOARDSCAN_X86
+    case SSE2: return scanSSE2;
+    case AVX2: return scanAVX2;
+#endif
+    default:   return scanScalar;
+    }
+}
+
+Kernel bestKernel()
+{
+#ifdef BOARDSCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return AVX2;
+    if (__builtin_cpu_supports("sse2")) return SSE2;
+#endif
+    return Scalar;
+}
+
+Kernel g_kernel = bestKernel();
+ScanFn g_scan   = kernelFn(g_kernel);
+}
+
+uint64_t scan(const char* cells, int count, char empty)
+{
+    return g_scan(cells, count, empty);
+}
+
+uint64_t scanWith(Kernel kernel, const char* cells, int count, char empty)
+{
+    return kernelFn(kernel)(cells, count, empty);
+}
+
+bool available(Kernel kernel)
+{
+    switch (kernel) {
+    case Scalar: return true;
+#ifdef BOARDSCAN_X86
+    case SSE2:   return __builtin_cpu_supports("sse2");
+    case AVX2:   return __builtin_cpu_supports("avx2");
+#endif
+    default:     return false;
+    }
+}
+
+const char* kernelName(Kernel kernel)
+{
+    switch (kernel) {
+    case Scalar: return "scalar";
+    case SSE2:   return "sse2";
+    case AVX2:   return "avx2";
+    default:     return "?";
+    }
+}
+
+Kernel activeKernel()
+{
+    return g_kernel;
+}
+
+bool useKernel(Kernel kernel)
+{
+    if (!available(kernel)) return false;
+    g_kernel = kernel;
+    g_scan   = kernelFn(kernel);
+    return true;
+}
+
+bool selfTest(std::ostream& out, int trials)
+{
+    static const char terrain[] = ".MPFXR";
+
+    std::mt19937 rng(12345);
+    std::vector<char> buffer(64 + 64);
+
+    bool ok = true;
+    for (int k = 0; k < NumKernels; ++k) {
+        Kernel kernel = static_cast<Kernel>(k);
+        if (!available(kernel)) {
+            out << "  " << kernelName(kernel) << ": not available on this CPU\n";
+            continue;
+        }
+
+        int failures = 0;
+        for (int t = 0; t < trials; ++t) {
+            // mostly-empty runs, like a real board, at random alignments
+            int density = static_cast<int>(rng() % 100);
+            for (auto& cell : buffer) {
+                cell = (static_cast<int>(rng() % 100) < density)
+                     ? terrain[1 + rng() % 5] : '.';
+            }
+            int offset = static_cast<int>(rng() % 64);
+            int count  = static_cast<int>(rng() % 65);
+
+            uint64_t want = scanScalar(buffer.data() + offset, count, '.');
+            uint64_t got  = scanWith(kernel, buffer.data() + offset, count, '.');
+            if (got != want && failures++ < 5) {
+                out << "  " << kernelName(kernel) << ": mismatch at offset "
+                    << offset << " count " << count << "\n";
+            }
+        }
+
+        out << "  " << kernelName(kernel) << ": " << trials << " runs, "
+            << failures << " mismatches"
+            << (kernel == g_kernel ? " (active)" : "") << "\n";
+        ok = ok && failures == 0;
+    }
+    return ok;
+}
+
+}
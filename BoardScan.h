@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+// Find the non-empty cells in a contiguous run of board bytes.
+//
+// scan() returns a bitmask with bit i set when cells[i] != empty, for up
+// to 64 cells. The arena uses it to classify axis-aligned radar rays a
+// chunk at a time instead of branching on every cell. On x86 the kernel
+// is picked once at startup - AVX2 when the CPU has it, otherwise SSE2 -
+// and everything else uses the scalar loop.
+namespace BoardScan {
+
+enum Kernel {
+    Scalar,
+    SSE2,
+    AVX2,
+    NumKernels
+};
+
+uint64_t scan(const char* cells, int count, char empty);
+
+// The same scan with a specific kernel; count must be <= 64.
+uint64_t scanWith(Kernel kernel, const char* cells, int count, char empty);
+
+bool        available(Kernel kernel);
+const char* kernelName(Kernel kernel);
+Kernel      activeKernel();
+
+// Force a kernel (e.g. Scalar, to compare against). Returns false and
+// changes nothing if this CPU can't run it.
+bool useKernel(Kernel kernel);
+
+// Differential check: random runs through every available kernel,
+// compared with the scalar result. Prints a line per kernel.
+bool selfTest(std::ostream& out, int trials = 100000);
+
+}
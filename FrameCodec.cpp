@@ -0,0 +1,217 @@
+#include "FrameCodec.h"
+
+namespace {
+enum FrameType : unsigned char { KeyFrame = 0, DeltaFrame = 1 };
+enum Changed : unsigned char { Row = 1, Col = 2, Health = 4, Armor = 8, Flags = 16 };
+
+uint64_t zigzag(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+bool getByte(const unsigned char*& p, const unsigned char* end, unsigned char& value)
+{
+    if (p == end) return false;
+    value = *p++;
+    return true;
+}
+
+bool getSigned(const unsigned char*& p, const unsigned char* end, int64_t& value)
+{
+    uint64_t raw;
+    if (!getVarint(p, end, raw)) return false;
+    value = unzigzag(raw);
+    return true;
+}
+}
+
+void putVarint(std::vector<unsigned char>& out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+bool getVarint(const unsigned char*& p, const unsigned char* end, uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p == end) return false;
+        unsigned char byte = *p++;
+        value |= uint64_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+FrameEncoder::FrameEncoder(uint32_t keyInterval)
+    : m_keyInterval(keyInterval ? keyInterval : 1)
+{
+}
+
+bool FrameEncoder::encode(const FeedFrame& frame, const FeedRobot* robots,
+                          std::vector<unsigned char>& out)
+{
+    bool key = !m_haveBase || m_sinceKey + 1 >= m_keyInterval ||
+               frame.kind == FeedFrame::Key || frame.match != m_frame.match ||
+               frame.robots != m_robots.size();
+
+    out.clear();
+    out.push_back(key ? KeyFrame : DeltaFrame);
+    putVarint(out, m_number++);
+    putVarint(out, frame.round);
+    putVarint(out, zigzag(frame.turn));
+
+    if (key) {
+        putVarint(out, frame.match);
+        putVarint(out, frame.seed);
+        putVarint(out, frame.kind);
+        putVarint(out, frame.robots);
+        for (size_t i = 0; i < frame.robots; ++i) {
+            const FeedRobot& r = robots[i];
+            out.push_back(static_cast<unsigned char>(r.symbol));
+            out.push_back(r.flags);
+            putVarint(out, r.row);
+            putVarint(out, r.col);
+            putVarint(out, zigzag(r.health));
+            putVarint(out, zigzag(r.armor));
+        }
+        m_robots.assign(robots, robots + frame.robots);
+        m_sinceKey = 0;
+    } else {
+        // count the events first so the reader knows when to stop
+        size_t events = 0;
+        for (size_t i = 0; i < m_robots.size(); ++i) {
+            const FeedRobot& a = m_robots[i];
+            const FeedRobot& b = robots[i];
+            events += a.row != b.row || a.col != b.col || a.health != b.health ||
+                      a.armor != b.armor || a.flags != b.flags;
+        }
+        putVarint(out, events);
+
+        size_t next = 0;   // slot after the previous event
+        for (size_t i = 0; i < m_robots.size() && events > 0; ++i) {
+            FeedRobot&       a = m_robots[i];
+            const FeedRobot& b = robots[i];
+            unsigned char changed = (a.row != b.row ? Row : 0) | (a.col != b.col ? Col : 0) |
+                                    (a.health != b.health ? Health : 0) |
+                                    (a.armor != b.armor ? Armor : 0) |
+                                    (a.flags != b.flags ? Flags : 0);
+            if (!changed) continue;
+
+            putVarint(out, i - next);
+            out.push_back(changed);
+            if (changed & Row)    putVarint(out, zigzag(int64_t(b.row) - a.row));
+            if (changed & Col)    putVarint(out, zigzag(int64_t(b.col) - a.col));
+            if (changed & Health) putVarint(out, zigzag(int64_t(b.health) - a.health));
+            if (changed & Armor)  putVarint(out, zigzag(int64_t(b.armor) - a.armor));
+            if (changed & Flags)  out.push_back(b.flags);
+
+            a = b;
+            next = i + 1;
+            --events;
+        }
+        ++m_sinceKey;
+    }
+
+    m_frame    = frame;
+    m_haveBase = true;
+    return key;
+}
+
+bool FrameDecoder::decode(const unsigned char* data, size_t size)
+{
+    const unsigned char* p   = data;
+    const unsigned char* end = data + size;
+
+    unsigned char type;
+    uint64_t number, round;
+    int64_t  turn;
+    if (!getByte(p, end, type) || !getVarint(p, end, number) ||
+        !getVarint(p, end, round) || !getSigned(p, end, turn)) {
+        return false;
+    }
+
+    if (type == KeyFrame) {
+        uint64_t match, seed, kind, robots;
+        if (!getVarint(p, end, match) || !getVarint(p, end, seed) ||
+            !getVarint(p, end, kind) || !getVarint(p, end, robots) ||
+            robots > size) {
+            m_ready = false;
+            return false;
+        }
+
+        m_robots.resize(robots);
+        for (auto& r : m_robots) {
+            unsigned char symbol, flags;
+            uint64_t row, col;
+            int64_t  health, armor;
+            if (!getByte(p, end, symbol) || !getByte(p, end, flags) ||
+                !getVarint(p, end, row) || !getVarint(p, end, col) ||
+                !getSigned(p, end, health) || !getSigned(p, end, armor)) {
+                m_ready = false;
+                return false;
+            }
+            r = FeedRobot{static_cast<char>(symbol), flags,
+                          static_cast<uint16_t>(row), static_cast<uint16_t>(col),
+                          static_cast<int16_t>(health), static_cast<int16_t>(armor), 0};
+        }
+
+        m_frame.match  = match;
+        m_frame.seed   = static_cast<uint32_t>(seed);
+        m_frame.kind   = static_cast<uint16_t>(kind);
+        m_frame.robots = static_cast<uint16_t>(robots);
+    } else if (type == DeltaFrame) {
+        if (!m_ready || number != m_number + 1) {
+            m_ready = false;
+            return false;
+        }
+
+        uint64_t events;
+        if (!getVarint(p, end, events)) {
+            m_ready = false;
+            return false;
+        }
+
+        uint64_t slot = 0;
+        for (uint64_t e = 0; e < events; ++e) {
+            uint64_t      gap;
+            unsigned char changed;
+            if (!getVarint(p, end, gap) || !getByte(p, end, changed) ||
+                (slot += gap) >= m_robots.size()) {
+                m_ready = false;
+                return false;
+            }
+
+            FeedRobot& r = m_robots[slot++];
+            int64_t delta = 0;
+            bool ok = true;
+            if (ok && (changed & Row))    { ok = getSigned(p, end, delta); r.row    = static_cast<uint16_t>(r.row + delta); }
+            if (ok && (changed & Col))    { ok = getSigned(p, end, delta); r.col    = static_cast<uint16_t>(r.col + delta); }
+            if (ok && (changed & Health)) { ok = getSigned(p, end, delta); r.health = static_cast<int16_t>(r.health + delta); }
+            if (ok && (changed & Armor))  { ok = getSigned(p, end, delta); r.armor  = static_cast<int16_t>(r.armor + delta); }
+            if (ok && (changed & Flags))  { ok = getByte(p, end, r.flags); }
+            if (!ok) {
+                m_ready = false;
+                return false;
+            }
+        }
+        m_frame.kind = FeedFrame::Turn;
+    } else {
+        return false;
+    }
+
+    m_frame.round = static_cast<uint32_t>(round);
+    m_frame.turn  = static_cast<int32_t>(turn);
+    m_number      = number;
+    m_ready       = true;
+    m_lastWasKey  = type == KeyFrame;
+    return true;
+}
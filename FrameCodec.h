@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "SpectatorFeed.h"
+
+// Frame codec
+// -----------
+// Turns the per-turn robot table (a FeedFrame and its FeedRobots) into
+// compact bytes for the spectator feed and replay files. Most frames are
+// deltas against the frame before: only the robots whose position,
+// health, armor or flags changed, as varint-packed events, so a turn in
+// which one robot moved costs a dozen bytes whatever the board or roster
+// size. A key frame with the whole table is written for the first frame,
+// at each new match or roster size, and every keyInterval frames, so a
+// reader that missed frames can pick up again.
+//
+// Encoded frame (varints are LEB128, signed values zigzag-encoded):
+//   u8     type                 0 key, 1 delta
+//   varint number               frames since the encoder started
+//   varint round, zigzag turn
+//   key:   varint match, seed, kind, robots
+//          per robot: u8 symbol, u8 flags, varint row, col,
+//                     zigzag health, zigzag armor
+//   delta: varint events, then per event:
+//          varint slot gap      slot minus previous event's slot + 1
+//          u8     changed       Row | Col | Health | Armor | Flags bits
+//          zigzag delta of each changed field in that order
+//          (u8 value for Flags)
+//
+// A delta only applies on top of the frame numbered one less.
+
+class FrameEncoder {
+public:
+    explicit FrameEncoder(uint32_t keyInterval = 64);
+
+    // Replace out with the encoding of this frame. Returns true if it was
+    // written as a key frame.
+    bool encode(const FeedFrame& frame, const FeedRobot* robots,
+                std::vector<unsigned char>& out);
+
+    // Make the next frame a key frame.
+    void reset() { m_haveBase = false; }
+
+private:
+    uint32_t               m_keyInterval;
+    uint32_t               m_sinceKey = 0;
+    uint64_t               m_number   = 0;
+    bool                   m_haveBase = false;
+    FeedFrame              m_frame{};
+    std::vector<FeedRobot> m_robots;
+};
+
+class FrameDecoder {
+public:
+    // Apply one encoded frame. Returns false if the bytes are malformed,
+    // or if they are a delta that doesn't follow the last frame decoded
+    // (frames were missed); the decoder then waits for a key frame.
+    bool decode(const unsigned char* data, size_t size);
+
+    // Whether frame()/robots() hold a decoded table.
+    bool ready() const { return m_ready; }
+
+    const FeedFrame&              frame() const  { return m_frame; }
+    const std::vector<FeedRobot>& robots() const { return m_robots; }
+
+    // Was the last frame decode() accepted a key frame?
+    bool lastWasKey() const { return m_lastWasKey; }
+
+private:
+    bool                   m_ready      = false;
+    bool                   m_lastWasKey = false;
+    uint64_t               m_number     = 0;
+    FeedFrame              m_frame{};
+    std::vector<FeedRobot> m_robots;
+};
+
+// The varint helpers, for formats built around frames (replay files).
+void putVarint(std::vector<unsigned char>& out, uint64_t value);
+bool getVarint(const unsigned char*& p, const unsigned char* end, uint64_t& value);
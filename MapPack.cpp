@@ -0,0 +1,432 @@
+#include "MapPack.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+size_t padTo8(size_t n)
+{
+    return (n + 7) & ~size_t(7);
+}
+
+size_t recordBytes(uint32_t rows, uint32_t cols, uint32_t spawnSlots)
+{
+    return padTo8(sizeof(uint32_t) + sizeof(MapSpawn) * spawnSlots +
+                  size_t(rows) * cols);
+}
+
+// One map under construction.
+class MapBuilder {
+public:
+    MapBuilder(const MapGenOptions& options, std::mt19937& rng)
+        : m_rows(options.rows),
+          m_cols(options.cols),
+          m_rng(rng),
+          m_cells(size_t(options.rows) * options.cols, '.')
+    {
+    }
+
+    bool isFree(int r, int c) const
+    {
+        return inBounds(r, c) && at(r, c) == '.';
+    }
+
+    bool inBounds(int r, int c) const
+    {
+        return r >= 0 && r < m_rows && c >= 0 && c < m_cols;
+    }
+
+    char  at(int r, int c) const { return m_cells[r * m_cols + c]; }
+    char& at(int r, int c)       { return m_cells[r * m_cols + c]; }
+
+    int randomRow() { return static_cast<int>(m_rng() % m_rows); }
+    int randomCol() { return static_cast<int>(m_rng() % m_cols); }
+
+    // A random free cell, or false once the board is (nearly) full.
+    bool randomFree(int& r, int& c)
+    {
+        for (int tries = 0; tries < m_rows * m_cols * 4; ++tries) {
+            r = randomRow();
+            c = randomCol();
+            if (isFree(r, c)) return true;
+        }
+        return false;
+    }
+
+    void scatter(int count, char ch)
+    {
+        for (int placed = 0; placed < count; ++placed) {
+            int r, c;
+            if (!randomFree(r, c)) return;
+            at(r, c) = ch;
+        }
+    }
+
+    // Each piece grows from an earlier one of its kind most of the time.
+    void clusters(int count, char ch)
+    {
+        std::vector<std::pair<int, int>> placed;
+        while (static_cast<int>(placed.size()) < count) {
+            int r = -1, c = -1;
+            if (!placed.empty() && m_rng() % 4 != 0) {
+                auto [pr, pc] = placed[m_rng() % placed.size()];
+                r = pr + static_cast<int>(m_rng() % 3) - 1;
+                c = pc + static_cast<int>(m_rng() % 3) - 1;
+            }
+            if (!isFree(r, c) && !randomFree(r, c)) return;
+            at(r, c) = ch;
+            placed.emplace_back(r, c);
+        }
+    }
+
+    // Straight mound walls 3-6 long; a wall stops early at anything in
+    // its way, which leaves gaps to get through.
+    void walls(int count)
+    {
+        int placed = 0;
+        while (placed < count) {
+            int r, c;
+            if (!randomFree(r, c)) return;
+            bool across = m_rng() % 2 == 0;
+            int  length = 3 + static_cast<int>(m_rng() % 4);
+            for (int i = 0; i < length && placed < count && isFree(r, c); ++i) {
+                at(r, c) = 'M';
+                ++placed;
+                if (across) ++c; else ++r;
+            }
+        }
+    }
+
+    // Place count pieces as pairs mirrored through the board's center. A
+    // lone piece can only sit on the center cell itself, which exists when
+    // both sides are odd; otherwise an odd count is rounded down.
+    void mirrored(int count, char ch)
+    {
+        int placed = 0;
+        if (count % 2 == 1) {
+            int cr = m_rows / 2;
+            int cc = m_cols / 2;
+            if (m_rows % 2 == 1 && m_cols % 2 == 1 && isFree(cr, cc)) {
+                at(cr, cc) = ch;
+            }
+            --count;
+        }
+
+        for (int tries = 0; placed < count && tries < m_rows * m_cols * 4; ++tries) {
+            int r, c;
+            if (!randomFree(r, c)) return;
+            int tr = m_rows - 1 - r;
+            int tc = m_cols - 1 - c;
+            if ((tr != r || tc != c) && isFree(tr, tc)) {
+                at(r, c)   = ch;
+                at(tr, tc) = ch;
+                placed += 2;
+            }
+        }
+    }
+
+    bool pointSymmetric() const
+    {
+        for (int r = 0; r < m_rows; ++r) {
+            for (int c = 0; c < m_cols; ++c) {
+                if (at(r, c) != at(m_rows - 1 - r, m_cols - 1 - c)) return false;
+            }
+        }
+        return true;
+    }
+
+    // Symmetric spawns come in mirrored pairs, plus the center cell for an
+    // odd count (generateMap() rejects odd counts on boards without one).
+    bool placeSpawns(int count, int minSeparation, bool symmetric,
+                     std::vector<MapSpawn>& spawns)
+    {
+        auto separated = [&](int r, int c) {
+            for (const auto& s : spawns) {
+                int d = std::max(std::abs(s.row - r), std::abs(s.col - c));
+                if (d < minSeparation) return false;
+            }
+            return true;
+        };
+
+        spawns.clear();
+        if (symmetric && count % 2 == 1) {
+            int cr = m_rows / 2;
+            int cc = m_cols / 2;
+            if (!isFree(cr, cc)) return false;
+            spawns.push_back(MapSpawn{uint16_t(cr), uint16_t(cc)});
+        }
+
+        for (int tries = 0; static_cast<int>(spawns.size()) < count; ++tries) {
+            if (tries > m_rows * m_cols * 4) return false;
+
+            int r, c;
+            if (!randomFree(r, c) || !separated(r, c)) continue;
+            spawns.push_back(MapSpawn{uint16_t(r), uint16_t(c)});
+
+            if (symmetric) {
+                int tr = m_rows - 1 - r;
+                int tc = m_cols - 1 - c;
+                if ((tr == r && tc == c) || !isFree(tr, tc) || !separated(tr, tc)) {
+                    spawns.pop_back();
+                    continue;
+                }
+                spawns.push_back(MapSpawn{uint16_t(tr), uint16_t(tc)});
+            }
+        }
+        return true;
+    }
+
+    static bool spawnsSymmetric(const std::vector<MapSpawn>& spawns, int rows, int cols)
+    {
+        for (const auto& s : spawns) {
+            bool mirrored = false;
+            for (const auto& t : spawns) {
+                mirrored = mirrored || (t.row == rows - 1 - s.row && t.col == cols - 1 - s.col);
+            }
+            if (!mirrored) return false;
+        }
+        return true;
+    }
+
+    // Can a robot walk (8-connected, around mounds and pits) between
+    // every pair of spawns?
+    bool spawnsConnected(const std::vector<MapSpawn>& spawns) const
+    {
+        if (spawns.empty()) return true;
+
+        std::vector<char> seen(m_cells.size(), 0);
+        std::vector<int>  queue;
+        int start = spawns[0].row * m_cols + spawns[0].col;
+        seen[start] = 1;
+        queue.push_back(start);
+
+        for (size_t head = 0; head < queue.size(); ++head) {
+            int r = queue[head] / m_cols;
+            int c = queue[head] % m_cols;
+            for (int dr = -1; dr <= 1; ++dr) {
+                for (int dc = -1; dc <= 1; ++dc) {
+                    int nr = r + dr;
+                    int nc = c + dc;
+                    if (!inBounds(nr, nc)) continue;
+                    int n = nr * m_cols + nc;
+                    if (seen[n] || at(nr, nc) == 'M' || at(nr, nc) == 'P') continue;
+                    seen[n] = 1;
+                    queue.push_back(n);
+                }
+            }
+        }
+
+        for (const auto& s : spawns) {
+            if (!seen[s.row * m_cols + s.col]) return false;
+        }
+        return true;
+    }
+
+    std::vector<char>& cells() { return m_cells; }
+
+private:
+    int               m_rows;
+    int               m_cols;
+    std::mt19937&     m_rng;
+    std::vector<char> m_cells;
+};
+}
+
+const char* mapStyleName(MapGenOptions::Style style)
+{
+    switch (style) {
+    case MapGenOptions::Scatter:   return "scatter";
+    case MapGenOptions::Clusters:  return "clusters";
+    case MapGenOptions::Corridors: return "corridors";
+    case MapGenOptions::Symmetric: return "symmetric";
+    case MapGenOptions::Mixed:     return "mixed";
+    default:                       return "?";
+    }
+}
+
+bool generateMap(const MapGenOptions& options, uint32_t index, GeneratedMap& map)
+{
+    MapGenOptions::Style style = options.style;
+    if (style == MapGenOptions::Mixed) {
+        style = static_cast<MapGenOptions::Style>(index % MapGenOptions::Mixed);
+    }
+
+    bool symmetric = style == MapGenOptions::Symmetric;
+    if (symmetric && options.spawns % 2 == 1 &&
+        (options.rows % 2 == 0 || options.cols % 2 == 0)) {
+        throw std::runtime_error("Symmetric maps need an even spawn count unless both "
+                                 "sides are odd (a lone spawn takes the center cell)");
+    }
+
+    std::seed_seq seq{index, static_cast<uint32_t>(style), 0x6d617073u};
+    std::mt19937  rng(seq);
+
+    for (int attempt = 0; attempt < 64; ++attempt) {
+        MapBuilder board(options, rng);
+
+        switch (style) {
+        case MapGenOptions::Clusters:
+            board.clusters(options.mounds,  'M');
+            board.clusters(options.pits,    'P');
+            board.clusters(options.flamers, 'F');
+            break;
+        case MapGenOptions::Corridors:
+            board.walls(options.mounds);
+            board.scatter(options.pits,    'P');
+            board.scatter(options.flamers, 'F');
+            break;
+        case MapGenOptions::Symmetric:
+            // keep the center cell for a lone spawn
+            if (options.spawns % 2 == 1) board.at(options.rows / 2, options.cols / 2) = 'S';
+            board.mirrored(options.mounds,  'M');
+            board.mirrored(options.pits,    'P');
+            board.mirrored(options.flamers, 'F');
+            if (options.spawns % 2 == 1) board.at(options.rows / 2, options.cols / 2) = '.';
+            break;
+        default:
+            board.scatter(options.mounds,  'M');
+            board.scatter(options.pits,    'P');
+            board.scatter(options.flamers, 'F');
+            break;
+        }
+
+        if (symmetric && !board.pointSymmetric()) {
+            throw std::runtime_error("Symmetric map " + std::to_string(index) +
+                                     " came out asymmetric");
+        }
+        if (!board.placeSpawns(options.spawns, options.minSpawnSeparation,
+                               symmetric, map.spawns)) {
+            continue;
+        }
+        if (symmetric && !MapBuilder::spawnsSymmetric(map.spawns, options.rows, options.cols)) {
+            throw std::runtime_error("Symmetric map " + std::to_string(index) +
+                                     " got asymmetric spawns");
+        }
+        if (!board.spawnsConnected(map.spawns)) {
+            continue;
+        }
+
+        map.cells = std::move(board.cells());
+        return true;
+    }
+    return false;
+}
+
+void writeMapPack(const std::string& path, const MapGenOptions& options,
+                  const std::vector<GeneratedMap>& maps)
+{
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        throw std::runtime_error("Cannot create map pack " + path);
+    }
+
+    MapPackHeader header{mapPackMagic, mapPackVersion,
+                         static_cast<uint32_t>(options.rows),
+                         static_cast<uint32_t>(options.cols),
+                         static_cast<uint32_t>(maps.size()),
+                         static_cast<uint32_t>(options.spawns)};
+    std::fwrite(&header, sizeof(header), 1, f);
+
+    std::vector<unsigned char> record(recordBytes(header.rows, header.cols, header.spawnSlots));
+    for (const auto& map : maps) {
+        std::fill(record.begin(), record.end(), 0);
+
+        uint32_t spawnCount = static_cast<uint32_t>(
+            std::min<size_t>(map.spawns.size(), header.spawnSlots));
+        unsigned char* p = record.data();
+        std::memcpy(p, &spawnCount, sizeof(spawnCount));
+        p += sizeof(spawnCount);
+        std::memcpy(p, map.spawns.data(), sizeof(MapSpawn) * spawnCount);
+        p += sizeof(MapSpawn) * header.spawnSlots;
+        std::memcpy(p, map.cells.data(), size_t(header.rows) * header.cols);
+
+        std::fwrite(record.data(), 1, record.size(), f);
+    }
+
+    if (std::fclose(f) != 0) {
+        throw std::runtime_error("Failed writing map pack " + path);
+    }
+}
+
+std::shared_ptr<const MapPack> MapPack::open(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open map pack " + path);
+    }
+
+    struct stat st {};
+    fstat(fd, &st);
+
+    std::shared_ptr<MapPack> pack(new MapPack);
+    pack->m_size = static_cast<size_t>(st.st_size);
+    if (pack->m_size < sizeof(MapPackHeader)) {
+        close(fd);
+        throw std::runtime_error("Not a map pack: " + path);
+    }
+
+    void* p = mmap(nullptr, pack->m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        throw std::runtime_error("Cannot mmap map pack " + path);
+    }
+    pack->m_data = static_cast<const unsigned char*>(p);
+
+    MapPackHeader& header = pack->m_header;
+    std::memcpy(&header, pack->m_data, sizeof(header));
+    if (header.magic != mapPackMagic || header.version != mapPackVersion) {
+        throw std::runtime_error("Not a map pack (or wrong version): " + path);
+    }
+
+    pack->m_recordBytes = recordBytes(header.rows, header.cols, header.spawnSlots);
+    if (header.count == 0 ||
+        pack->m_size != sizeof(header) + pack->m_recordBytes * header.count) {
+        throw std::runtime_error("Map pack " + path + " is empty or truncated");
+    }
+
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < pack->m_size; ++i) {
+        hash ^= pack->m_data[i];
+        hash *= 1099511628211ull;
+    }
+    pack->m_hash = hash;
+
+    return pack;
+}
+
+MapPack::~MapPack()
+{
+    if (m_data) {
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+    }
+}
+
+const unsigned char* MapPack::record(size_t index) const
+{
+    return m_data + sizeof(MapPackHeader) + m_recordBytes * (index % size());
+}
+
+int MapPack::spawnCount(size_t index) const
+{
+    uint32_t count;
+    std::memcpy(&count, record(index), sizeof(count));
+    return static_cast<int>(count);
+}
+
+const MapSpawn* MapPack::spawns(size_t index) const
+{
+    return reinterpret_cast<const MapSpawn*>(record(index) + sizeof(uint32_t));
+}
+
+const char* MapPack::cells(size_t index) const
+{
+    return reinterpret_cast<const char*>(record(index) + sizeof(uint32_t) +
+                                         sizeof(MapSpawn) * m_header.spawnSlots);
+}
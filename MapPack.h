@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Pre-built arena maps.
+//
+// rwmapgen generates thousands of maps ahead of time into a map pack;
+// RobotWarz --maps mmaps the pack and each match copies map
+// (seed % size()) onto its board, so there is no map generation per match
+// and every run on the same pack and seeds plays the same maps.
+
+struct MapSpawn {
+    uint16_t row;
+    uint16_t col;
+};
+
+// Map pack layout
+// ---------------
+//   MapPackHeader
+//   count records of recordBytes each:
+//     u32 spawnCount
+//     MapSpawn[spawnSlots] spawns          (unused slots are zero)
+//     char[rows * cols]    cells, row-major: '.', 'M', 'P' or 'F'
+//     (pad to 8)
+
+constexpr uint32_t mapPackMagic   = 0x504D5752;   // "RWMP"
+constexpr uint32_t mapPackVersion = 1;
+
+struct MapPackHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t count;
+    uint32_t spawnSlots;
+};
+
+struct MapGenOptions {
+    enum Style {
+        Scatter,     // uniform random, like the arena's own placement
+        Clusters,    // obstacles grow in blobs
+        Corridors,   // mound walls with gaps, hazards in the lanes
+        Symmetric,   // everything mirrored through the center (fair spawns);
+                     // odd obstacle counts round down unless the board has a
+                     // free center cell; an odd spawn count needs that cell
+        Mixed,       // one of the above per map
+        NumStyles
+    };
+
+    int   rows    = 20;
+    int   cols    = 20;
+    int   mounds  = 5;
+    int   pits    = 3;
+    int   flamers = 3;
+    Style style   = Mixed;
+
+    // Spawn points per map. They are on empty cells, at least
+    // minSpawnSeparation apart (Chebyshev distance) and all connected by
+    // cells a robot can walk through.
+    int spawns             = 8;
+    int minSpawnSeparation = 4;
+};
+
+struct GeneratedMap {
+    std::vector<char>     cells;
+    std::vector<MapSpawn> spawns;
+};
+
+// Build map number index of a pack; the same options and index always
+// give the same map. Returns false if the constraints couldn't be met.
+bool generateMap(const MapGenOptions& options, uint32_t index, GeneratedMap& map);
+
+const char* mapStyleName(MapGenOptions::Style style);
+
+// Write maps (all options.rows x options.cols) as a map pack.
+void writeMapPack(const std::string& path, const MapGenOptions& options,
+                  const std::vector<GeneratedMap>& maps);
+
+// Read-only mmap of a map pack.
+class MapPack {
+public:
+    static std::shared_ptr<const MapPack> open(const std::string& path);
+    ~MapPack();
+
+    MapPack(const MapPack&) = delete;
+    MapPack& operator=(const MapPack&) = delete;
+
+    int      rows() const { return static_cast<int>(m_header.rows); }
+    int      cols() const { return static_cast<int>(m_header.cols); }
+    size_t   size() const { return m_header.count; }
+    uint64_t hash() const { return m_hash; }   // FNV-1a of the file
+
+    const char*     cells(size_t index) const;
+    int             spawnCount(size_t index) const;
+    const MapSpawn* spawns(size_t index) const;
+
+private:
+    MapPack() = default;
+
+    const unsigned char* record(size_t index) const;
+
+    const unsigned char* m_data = nullptr;
+    size_t               m_size = 0;
+    MapPackHeader        m_header{};
+    size_t               m_recordBytes = 0;
+    uint64_t             m_hash = 0;
+};
@@ -0,0 +1,175 @@
+#include "PerfCounters.h"
+
+#include <iomanip>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+struct EventSpec {
+    uint32_t type;
+    uint64_t config;
+};
+
+constexpr uint64_t cacheMiss(uint64_t cache)
+{
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+const EventSpec eventSpecs[PerfCounters::NumEvents] = {
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_L1D)},
+    {PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_LL)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+int openCounter(const EventSpec& spec)
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = spec.type;
+    attr.config         = spec.config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+
+    // this thread, any CPU
+    long fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    return static_cast<int>(fd);
+}
+}
+
+PerfCounters::PerfCounters()
+{
+    for (int e = 0; e < NumEvents; ++e) {
+        m_fds[e] = openCounter(eventSpecs[e]);
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+    for (int fd : m_fds) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+bool PerfCounters::available() const
+{
+    for (int fd : m_fds) {
+        if (fd >= 0) return true;
+    }
+    return false;
+}
+
+PerfCounters::Sample PerfCounters::read() const
+{
+    Sample sample{};
+    for (int e = 0; e < NumEvents; ++e) {
+        if (m_fds[e] < 0) continue;
+        uint64_t value = 0;
+        if (::read(m_fds[e], &value, sizeof(value)) == sizeof(value)) {
+            sample[e] = value;
+        }
+    }
+    return sample;
+}
+
+const char* PerfCounters::eventName(Event event)
+{
+    switch (event) {
+    case TaskClock:    return "task-ns";
+    case Cycles:       return "cycles";
+    case Instructions: return "instr";
+    case L1DMisses:    return "L1D-miss";
+    case LLCMisses:    return "LLC-miss";
+    case BranchMisses: return "br-miss";
+    case NumEvents:    break;
+    }
+    return "?";
+}
+
+void PerfReport::add(Phase phase, size_t slot, const PerfCounters::Sample& delta)
+{
+    if (slot >= m_totals.size()) {
+        m_totals.resize(slot + 1);
+    }
+    Totals& t = m_totals[slot][phase];
+    for (int e = 0; e < PerfCounters::NumEvents; ++e) {
+        t.counts[e] += delta[e];
+    }
+    ++t.calls;
+}
+
+const char* PerfReport::phaseName(Phase phase)
+{
+    switch (phase) {
+    case Radar:     return "radar";
+    case RobotCode: return "robot";
+    case Shot:      return "shot";
+    case Move:      return "move";
+    case NumPhases: break;
+    }
+    return "?";
+}
+
+void PerfReport::print(std::ostream& out, const PerfCounters& counters,
+                       const std::vector<std::string>& names) const
+{
+    if (!counters.available()) {
+        out << "Performance counters unavailable (perf_event_open failed; "
+               "check /proc/sys/kernel/perf_event_paranoid or container limits).\n";
+        return;
+    }
+
+    out << "\nPerformance counters per call (user space):\n";
+    out << std::left << std::setw(20) << "robot" << std::setw(7) << "phase"
+        << std::right << std::setw(10) << "calls";
+    for (int e = 0; e < PerfCounters::NumEvents; ++e) {
+        auto event = static_cast<PerfCounters::Event>(e);
+        if (counters.has(event)) {
+            out << std::setw(12) << PerfCounters::eventName(event);
+        }
+    }
+    out << std::setw(8) << "IPC" << "\n";
+
+    auto printRow = [&](const std::string& who, Phase phase, const Totals& t) {
+        if (t.calls == 0) return;
+        out << std::left << std::setw(20) << who.substr(0, 19)
+            << std::setw(7) << phaseName(phase)
+            << std::right << std::setw(10) << t.calls << std::fixed << std::setprecision(1);
+        for (int e = 0; e < PerfCounters::NumEvents; ++e) {
+            auto event = static_cast<PerfCounters::Event>(e);
+            if (counters.has(event)) {
+                out << std::setw(12) << double(t.counts[e]) / t.calls;
+            }
+        }
+        if (t.counts[PerfCounters::Cycles] > 0) {
+            out << std::setw(8) << std::setprecision(2)
+                << double(t.counts[PerfCounters::Instructions]) / t.counts[PerfCounters::Cycles];
+        } else {
+            out << std::setw(8) << "-";
+        }
+        out << "\n";
+    };
+
+    std::array<Totals, NumPhases> all{};
+    for (size_t slot = 0; slot < m_totals.size(); ++slot) {
+        std::string who = slot < names.size() ? names[slot] : "slot " + std::to_string(slot);
+        for (int p = 0; p < NumPhases; ++p) {
+            const Totals& t = m_totals[slot][p];
+            printRow(who, static_cast<Phase>(p), t);
+            for (int e = 0; e < PerfCounters::NumEvents; ++e) {
+                all[p].counts[e] += t.counts[e];
+            }
+            all[p].calls += t.calls;
+        }
+    }
+    for (int p = 0; p < NumPhases; ++p) {
+        printRow("(all robots)", static_cast<Phase>(p), all[p]);
+    }
+}
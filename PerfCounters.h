@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Linux hardware performance counters read with perf_event_open, counted
+// for the calling thread in user space only.
+//
+// Each counter is opened on its own, so a machine (or container) that
+// lacks some of them still reports the rest. When none can be opened,
+// available() is false and reads return zeros.
+class PerfCounters {
+public:
+    enum Event {
+        TaskClock,      // software counter, nanoseconds on CPU
+        Cycles,
+        Instructions,
+        L1DMisses,
+        LLCMisses,
+        BranchMisses,
+        NumEvents
+    };
+
+    using Sample = std::array<uint64_t, NumEvents>;
+
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const;
+    bool has(Event event) const { return m_fds[event] >= 0; }
+
+    Sample read() const;
+
+    static const char* eventName(Event event);
+
+private:
+    std::array<int, NumEvents> m_fds;
+};
+
+// Counter totals for the arena phases of a robot turn, per robot slot.
+class PerfReport {
+public:
+    enum Phase { Radar, RobotCode, Shot, Move, NumPhases };
+
+    void add(Phase phase, size_t slot, const PerfCounters::Sample& delta);
+
+    // names[slot] labels each robot row
+    void print(std::ostream& out, const PerfCounters& counters,
+               const std::vector<std::string>& names) const;
+
+    static const char* phaseName(Phase phase);
+
+private:
+    struct Totals {
+        PerfCounters::Sample counts{};
+        uint64_t             calls = 0;
+    };
+
+    // m_totals[slot][phase]
+    std::vector<std::array<Totals, NumPhases>> m_totals;
+};
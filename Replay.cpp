@@ -0,0 +1,141 @@
+#include "Replay.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+void putU32(std::vector<unsigned char>& out, uint32_t value)
+{
+    unsigned char bytes[4];
+    std::memcpy(bytes, &value, sizeof(value));
+    out.insert(out.end(), bytes, bytes + 4);
+}
+}
+
+ReplayWriter::ReplayWriter(const std::string& path, int rows, int cols)
+    : m_path(path), m_out(path, std::ios::binary | std::ios::trunc),
+      m_cells(size_t(rows) * cols)
+{
+    if (!m_out) {
+        throw std::runtime_error("Cannot create replay " + path);
+    }
+
+    std::vector<unsigned char> header;
+    putU32(header, replayMagic);
+    putU32(header, replayVersion);
+    putU32(header, static_cast<uint32_t>(rows));
+    putU32(header, static_cast<uint32_t>(cols));
+    m_out.write(reinterpret_cast<const char*>(header.data()), header.size());
+}
+
+void ReplayWriter::record(const FeedFrame& frame, const FeedRobot* robots,
+                          const char* names, const char* terrain)
+{
+    if (frame.kind == FeedFrame::Key) {
+        m_payload.clear();
+        putVarint(m_payload, frame.robots);
+        for (size_t i = 0; i < frame.robots; ++i) {
+            const char* name = names + i * feedNameBytes;
+            size_t length = strnlen(name, feedNameBytes);
+            putVarint(m_payload, length);
+            m_payload.insert(m_payload.end(), name, name + length);
+        }
+        m_payload.insert(m_payload.end(), terrain, terrain + m_cells);
+        writeRecord(ReplayReader::Match, m_payload);
+    }
+
+    m_encoder.encode(frame, robots, m_payload);
+    writeRecord(ReplayReader::Frame, m_payload);
+
+    if (!m_out) {
+        throw std::runtime_error("Cannot write replay " + m_path);
+    }
+}
+
+void ReplayWriter::writeRecord(unsigned char type, const std::vector<unsigned char>& payload)
+{
+    m_header.clear();
+    m_header.push_back(type);
+    putVarint(m_header, payload.size());
+    m_out.write(reinterpret_cast<const char*>(m_header.data()), m_header.size());
+    m_out.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+}
+
+ReplayReader::ReplayReader(const std::string& path)
+    : m_path(path), m_in(path, std::ios::binary)
+{
+    if (!m_in) {
+        throw std::runtime_error("Cannot open replay " + path);
+    }
+
+    uint32_t header[4];
+    if (!m_in.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+        header[0] != replayMagic) {
+        throw std::runtime_error(path + " is not a replay file");
+    }
+    if (header[1] != replayVersion) {
+        throw std::runtime_error(path + " has replay version " + std::to_string(header[1]) +
+                                 ", expected " + std::to_string(replayVersion));
+    }
+    m_rows = header[2];
+    m_cols = header[3];
+}
+
+bool ReplayReader::next(Type& type, std::vector<unsigned char>& payload)
+{
+    int first = m_in.get();
+    if (first == std::char_traits<char>::eof()) return false;
+
+    // the length varint, a byte at a time
+    unsigned char bytes[10];
+    size_t count = 0;
+    int byte;
+    do {
+        byte = m_in.get();
+        if (byte == std::char_traits<char>::eof() || count == sizeof(bytes)) {
+            throw std::runtime_error("Replay " + m_path + " is truncated");
+        }
+        bytes[count++] = static_cast<unsigned char>(byte);
+    } while (byte & 0x80);
+
+    const unsigned char* p = bytes;
+    uint64_t length = 0;
+    if (!getVarint(p, bytes + count, length) || length > (uint64_t(1) << 30)) {
+        throw std::runtime_error("Replay " + m_path + " is malformed");
+    }
+
+    payload.resize(length);
+    if (!m_in.read(reinterpret_cast<char*>(payload.data()), static_cast<std::streamsize>(length))) {
+        throw std::runtime_error("Replay " + m_path + " is truncated");
+    }
+    if (first != Match && first != Frame) {
+        throw std::runtime_error("Replay " + m_path + " is malformed");
+    }
+    type = static_cast<Type>(first);
+    return true;
+}
+
+bool ReplayReader::parseMatch(const std::vector<unsigned char>& payload,
+                              std::vector<char>& names, std::vector<char>& terrain) const
+{
+    const unsigned char* p   = payload.data();
+    const unsigned char* end = p + payload.size();
+
+    uint64_t robots;
+    if (!getVarint(p, end, robots) || robots > payload.size()) return false;
+
+    names.assign(robots * feedNameBytes, '\0');
+    for (uint64_t i = 0; i < robots; ++i) {
+        uint64_t length;
+        if (!getVarint(p, end, length) || length > size_t(end - p)) return false;
+        std::memcpy(&names[i * feedNameBytes], p,
+                    std::min<size_t>(length, feedNameBytes - 1));
+        p += length;
+    }
+
+    size_t cells = size_t(m_rows) * m_cols;
+    if (size_t(end - p) != cells) return false;
+    terrain.assign(p, end);
+    return true;
+}
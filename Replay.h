@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "FrameCodec.h"
+
+// Replay files
+// ------------
+// A recording of every turn of a run, for rwspectate --replay. Turns are
+// stored as frame codec frames (see FrameCodec.h), the same ones a live
+// feed carries, so a turn costs bytes in proportion to what changed in
+// it rather than to the roster or board size. Names and terrain are
+// written once per match.
+//
+//   header:  u32 magic "RWRP", u32 version, u32 rows, u32 cols
+//   records: u8 type, varint payload length, payload
+//     Match  varint robots, per robot varint length + name bytes,
+//            then rows * cols terrain bytes, row-major
+//     Frame  one codec frame
+//
+// A Match record always comes just before the key frame of its match.
+
+constexpr uint32_t replayMagic   = 0x50525752;   // "RWRP"
+constexpr uint32_t replayVersion = 1;
+
+// Writer side, owned by the arena.
+class ReplayWriter {
+public:
+    // Creates (or truncates) path; throws if it can't be opened.
+    ReplayWriter(const std::string& path, int rows, int cols);
+
+    // As SpectatorFeed::publish: key frames also pass names
+    // (frame.robots * feedNameBytes) and rows * cols terrain bytes.
+    void record(const FeedFrame& frame, const FeedRobot* robots,
+                const char* names = nullptr, const char* terrain = nullptr);
+
+private:
+    void writeRecord(unsigned char type, const std::vector<unsigned char>& payload);
+
+    std::string                m_path;
+    std::ofstream              m_out;
+    size_t                     m_cells;
+    FrameEncoder               m_encoder;
+    std::vector<unsigned char> m_payload;
+    std::vector<unsigned char> m_header;
+};
+
+// Reader side, for rwspectate.
+class ReplayReader {
+public:
+    enum Type : unsigned char { Match = 1, Frame = 2 };
+
+    // Throws if path can't be opened or isn't a replay file.
+    explicit ReplayReader(const std::string& path);
+
+    uint32_t rows() const { return m_rows; }
+    uint32_t cols() const { return m_cols; }
+
+    // Read the next record's payload. Returns false at the end of the
+    // file; throws if the file is truncated or malformed.
+    bool next(Type& type, std::vector<unsigned char>& payload);
+
+    // Split a Match payload into feedNameBytes names and the terrain.
+    bool parseMatch(const std::vector<unsigned char>& payload,
+                    std::vector<char>& names, std::vector<char>& terrain) const;
+
+private:
+    std::string   m_path;
+    std::ifstream m_in;
+    uint32_t      m_rows = 0;
+    uint32_t      m_cols = 0;
+};
@@ -0,0 +1,270 @@
+#include "ResultsStore.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+size_t padTo8(size_t n)
+{
+    return (n + 7) & ~size_t(7);
+}
+
+constexpr size_t matchU64Columns = 3;
+constexpr size_t matchU32Columns = 4;
+constexpr size_t robotU32Columns = 8;
+
+// version 1 had no heapKb
+size_t robotU32ColumnsOf(uint32_t version)
+{
+    return version == 1 ? robotU32Columns - 1 : robotU32Columns;
+}
+
+template <typename T>
+void writeColumn(std::FILE* f, const std::vector<T>& column)
+{
+    if (!column.empty()) {
+        std::fwrite(column.data(), sizeof(T), column.size(), f);
+    }
+}
+
+void writePadding(std::FILE* f, size_t written)
+{
+    static const char zeros[8] = {};
+    std::fwrite(zeros, 1, padTo8(written) - written, f);
+}
+}
+
+size_t resultsGroupBytes(uint32_t matches, uint32_t robotRows, uint32_t version)
+{
+    size_t bytes = sizeof(ResultsGroupHeader);
+    bytes += matchU64Columns * sizeof(uint64_t) * matches;
+    bytes += padTo8(matchU32Columns * sizeof(uint32_t) * matches);
+    bytes += padTo8(resultsNameBytes * robotRows +
+                    robotU32ColumnsOf(version) * sizeof(uint32_t) * robotRows);
+    return bytes;
+}
+
+ResultsWriter::ResultsWriter(const std::string& path, size_t groupSize)
+    : m_groupSize(groupSize ? groupSize : 1)
+{
+    int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open results file " + path);
+    }
+
+    struct stat st {};
+    fstat(fd, &st);
+    size_t size = static_cast<size_t>(st.st_size);
+
+    if (size > 0) {
+        // groups of another version would be misread as this one's
+        ResultsFileHeader header{};
+        bool ok = pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                  header.magic == resultsFileMagic && header.version == resultsVersion;
+        if (!ok) {
+            close(fd);
+            throw std::runtime_error("Not a results file (or wrong version): " + path);
+        }
+
+        // A run that died mid-flush leaves a torn group at the end; the
+        // reader stops there, so anything appended after it would be lost.
+        // Cut the file back to its last complete group.
+        size_t end = sizeof(header);
+        ResultsGroupHeader group{};
+        while (end + sizeof(group) <= size &&
+               pread(fd, &group, sizeof(group), static_cast<off_t>(end)) ==
+                   static_cast<ssize_t>(sizeof(group)) &&
+               group.magic == resultsGroupMagic &&
+               end + resultsGroupBytes(group.matches, group.robotRows) <= size) {
+            end += resultsGroupBytes(group.matches, group.robotRows);
+        }
+        if (end < size && ftruncate(fd, static_cast<off_t>(end)) != 0) {
+            close(fd);
+            throw std::runtime_error("Cannot trim torn group from results file " + path);
+        }
+    }
+
+    m_file = fdopen(fd, "ab");
+    if (!m_file) {
+        close(fd);
+        throw std::runtime_error("Cannot open results file " + path);
+    }
+    if (size == 0) {
+        ResultsFileHeader header{resultsFileMagic, resultsVersion};
+        std::fwrite(&header, sizeof(header), 1, m_file);
+    }
+}
+
+ResultsWriter::~ResultsWriter()
+{
+    flush();
+    std::fclose(m_file);
+}
+
+void ResultsWriter::append(const MatchRecord& record)
+{
+    m_pending.push_back(record);
+    if (m_pending.size() >= m_groupSize) {
+        flush();
+    }
+}
+
+void ResultsWriter::flush()
+{
+    if (m_pending.empty()) return;
+
+    // transpose the buffered rows into columns
+    std::vector<uint64_t> seed, configHash, wallNanos;
+    std::vector<int32_t>  winner;
+    std::vector<uint32_t> rounds, firstRobot, robotCount;
+    std::vector<char>     names;
+    std::vector<uint32_t> robotCols[robotU32Columns];
+
+    for (const auto& rec : m_pending) {
+        seed.push_back(rec.seed);
+        configHash.push_back(rec.configHash);
+        wallNanos.push_back(rec.wallNanos);
+        winner.push_back(rec.winner);
+        rounds.push_back(rec.rounds);
+        firstRobot.push_back(static_cast<uint32_t>(robotCols[0].size()));
+        robotCount.push_back(static_cast<uint32_t>(rec.robots.size()));
+
+        for (const auto& r : rec.robots) {
+            char name[resultsNameBytes] = {};
+            std::strncpy(name, r.name.c_str(), resultsNameBytes - 1);
+            names.insert(names.end(), name, name + resultsNameBytes);
+
+            const uint32_t values[robotU32Columns] = {
+                r.damageDealt, r.damageTaken, r.shots, r.moves,
+                r.pitEvents, r.flameEvents, r.survived, r.heapKb
+            };
+            for (size_t c = 0; c < robotU32Columns; ++c) {
+                robotCols[c].push_back(values[c]);
+            }
+        }
+    }
+
+    ResultsGroupHeader header{resultsGroupMagic,
+                              static_cast<uint32_t>(m_pending.size()),
+                              static_cast<uint32_t>(robotCols[0].size()), 0};
+    std::fwrite(&header, sizeof(header), 1, m_file);
+
+    writeColumn(m_file, seed);
+    writeColumn(m_file, configHash);
+    writeColumn(m_file, wallNanos);
+
+    writeColumn(m_file, winner);
+    writeColumn(m_file, rounds);
+    writeColumn(m_file, firstRobot);
+    writeColumn(m_file, robotCount);
+    writePadding(m_file, matchU32Columns * sizeof(uint32_t) * header.matches);
+
+    writeColumn(m_file, names);
+    for (const auto& column : robotCols) {
+        writeColumn(m_file, column);
+    }
+    writePadding(m_file, (resultsNameBytes + robotU32Columns * sizeof(uint32_t)) *
+                         header.robotRows);
+
+    std::fflush(m_file);
+    m_pending.clear();
+}
+
+std::string ResultsGroup::robotName(uint32_t row) const
+{
+    const char* p = name + row * resultsNameBytes;
+    return std::string(p, strnlen(p, resultsNameBytes));
+}
+
+ResultsReader::ResultsReader(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open results file " + path);
+    }
+
+    struct stat st {};
+    fstat(fd, &st);
+    m_size = static_cast<size_t>(st.st_size);
+
+    if (m_size > 0) {
+        void* p = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Cannot mmap results file " + path);
+        }
+        m_data = static_cast<const unsigned char*>(p);
+        madvise(p, m_size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    ResultsFileHeader header{};
+    if (m_size < sizeof(header)) {
+        throw std::runtime_error("Not a results file: " + path);
+    }
+    std::memcpy(&header, m_data, sizeof(header));
+    if (header.magic != resultsFileMagic || header.version < 1 ||
+        header.version > resultsVersion) {
+        throw std::runtime_error("Not a results file (or wrong version): " + path);
+    }
+    m_version = header.version;
+    m_offset  = sizeof(header);
+}
+
+ResultsReader::~ResultsReader()
+{
+    if (m_data) {
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+    }
+}
+
+bool ResultsReader::nextGroup(ResultsGroup& group)
+{
+    if (m_offset + sizeof(ResultsGroupHeader) > m_size) return false;
+
+    ResultsGroupHeader header{};
+    std::memcpy(&header, m_data + m_offset, sizeof(header));
+    if (header.magic != resultsGroupMagic) return false;
+
+    size_t bytes = resultsGroupBytes(header.matches, header.robotRows, m_version);
+    if (m_offset + bytes > m_size) return false;   // torn final group
+
+    const unsigned char* p = m_data + m_offset + sizeof(header);
+    auto take = [&p](size_t n) { const unsigned char* at = p; p += n; return at; };
+
+    uint32_t m = header.matches;
+    uint32_t r = header.robotRows;
+
+    group.matches    = m;
+    group.robotRows  = r;
+    group.seed       = reinterpret_cast<const uint64_t*>(take(8 * m));
+    group.configHash = reinterpret_cast<const uint64_t*>(take(8 * m));
+    group.wallNanos  = reinterpret_cast<const uint64_t*>(take(8 * m));
+    group.winner     = reinterpret_cast<const int32_t*>(take(4 * m));
+    group.rounds     = reinterpret_cast<const uint32_t*>(take(4 * m));
+    group.firstRobot = reinterpret_cast<const uint32_t*>(take(4 * m));
+    group.robotCount = reinterpret_cast<const uint32_t*>(take(4 * m));
+    take(padTo8(16 * size_t(m)) - 16 * size_t(m));
+
+    group.name        = reinterpret_cast<const char*>(take(resultsNameBytes * r));
+    group.damageDealt = reinterpret_cast<const uint32_t*>(take(4 * r));
+    group.damageTaken = reinterpret_cast<const uint32_t*>(take(4 * r));
+    group.shots       = reinterpret_cast<const uint32_t*>(take(4 * r));
+    group.moves       = reinterpret_cast<const uint32_t*>(take(4 * r));
+    group.pitEvents   = reinterpret_cast<const uint32_t*>(take(4 * r));
+    group.flameEvents = reinterpret_cast<const uint32_t*>(take(4 * r));
+    group.survived    = reinterpret_cast<const uint32_t*>(take(4 * r));
+    if (m_version >= 2) {
+        group.heapKb = reinterpret_cast<const uint32_t*>(take(4 * r));
+    } else {
+        if (m_zeros.size() < r) m_zeros.assign(r, 0);
+        group.heapKb = m_zeros.data();
+    }
+
+    m_offset += bytes;
+    return true;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Per-robot numbers for one match.
+struct RobotMatchStats {
+    std::string name;
+    uint32_t damageDealt = 0;
+    uint32_t damageTaken = 0;
+    uint32_t shots       = 0;
+    uint32_t moves       = 0;   // cells moved
+    uint32_t pitEvents   = 0;
+    uint32_t flameEvents = 0;
+    uint32_t survived    = 0;
+    uint32_t heapKb      = 0;   // most heap the robot held
+};
+
+// One finished match. winner indexes robots, or is -1 for a draw.
+struct MatchRecord {
+    uint64_t seed       = 0;
+    uint64_t configHash = 0;
+    uint64_t wallNanos  = 0;
+    int32_t  winner     = -1;
+    uint32_t rounds     = 0;
+    std::vector<RobotMatchStats> robots;
+};
+
+// Results file layout
+// -------------------
+// A file header followed by append-only row groups. Each group stores its
+// matches column by column, then the robot rows of those matches column by
+// column, so a query only touches the columns it reads:
+//
+//   FileHeader
+//   GroupHeader { magic, matches M, robotRows R }
+//     u64[M] seed, configHash, wallNanos
+//     u32[M] winner, rounds, firstRobot, robotCount   (+pad to 8)
+//     char[R][32] name
+//     u32[R] damageDealt, damageTaken, shots, moves,
+//            pitEvents, flameEvents, survived, heapKb (+pad to 8)
+//
+// firstRobot is relative to the group. A group cut short by a crash is
+// ignored by the reader, and cut off by the next writer to open the file
+// so later groups don't land behind it. Version 1 files lack the heapKb
+// column; the reader takes them (heapKb reads as 0), the writer refuses
+// to append to them.
+
+constexpr uint32_t resultsFileMagic  = 0x53525752;   // "RWRS"
+constexpr uint32_t resultsGroupMagic = 0x50524752;   // "RGRP"
+constexpr uint32_t resultsVersion    = 2;
+constexpr size_t   resultsNameBytes  = 32;
+
+struct ResultsFileHeader {
+    uint32_t magic;
+    uint32_t version;
+};
+
+struct ResultsGroupHeader {
+    uint32_t magic;
+    uint32_t matches;
+    uint32_t robotRows;
+    uint32_t reserved;
+};
+
+size_t resultsGroupBytes(uint32_t matches, uint32_t robotRows,
+                         uint32_t version = resultsVersion);
+
+// Buffers records and appends them to the file one row group at a time.
+class ResultsWriter {
+public:
+    explicit ResultsWriter(const std::string& path, size_t groupSize = 1024);
+    ~ResultsWriter();
+
+    ResultsWriter(const ResultsWriter&) = delete;
+    ResultsWriter& operator=(const ResultsWriter&) = delete;
+
+    void append(const MatchRecord& record);
+    void flush();
+
+private:
+    std::FILE*               m_file = nullptr;
+    size_t                   m_groupSize;
+    std::vector<MatchRecord> m_pending;
+};
+
+// Column pointers into one mapped row group.
+struct ResultsGroup {
+    uint32_t matches   = 0;
+    uint32_t robotRows = 0;
+
+    const uint64_t* seed       = nullptr;
+    const uint64_t* configHash = nullptr;
+    const uint64_t* wallNanos  = nullptr;
+    const int32_t*  winner     = nullptr;
+    const uint32_t* rounds     = nullptr;
+    const uint32_t* firstRobot = nullptr;
+    const uint32_t* robotCount = nullptr;
+
+    const char*     name        = nullptr;   // robotRows * resultsNameBytes
+    const uint32_t* damageDealt = nullptr;
+    const uint32_t* damageTaken = nullptr;
+    const uint32_t* shots       = nullptr;
+    const uint32_t* moves       = nullptr;
+    const uint32_t* pitEvents   = nullptr;
+    const uint32_t* flameEvents = nullptr;
+    const uint32_t* survived    = nullptr;
+    const uint32_t* heapKb      = nullptr;
+
+    std::string robotName(uint32_t row) const;
+};
+
+// Read-only mmap of a results file.
+class ResultsReader {
+public:
+    explicit ResultsReader(const std::string& path);
+    ~ResultsReader();
+
+    ResultsReader(const ResultsReader&) = delete;
+    ResultsReader& operator=(const ResultsReader&) = delete;
+
+    // Walk the complete row groups in file order. Returns false when done.
+    bool nextGroup(ResultsGroup& group);
+
+private:
+    const unsigned char*  m_data    = nullptr;
+    size_t                m_size    = 0;
+    size_t                m_offset  = 0;
+    uint32_t              m_version = resultsVersion;
+    std::vector<uint32_t> m_zeros;   // stands in for columns the version lacks
+};
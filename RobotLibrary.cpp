@@ -0,0 +1,86 @@
+#include "RobotLibrary.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <dlfcn.h>
+
+namespace {
+std::mutex                                         g_libraryMutex;
+std::map<std::string, std::weak_ptr<RobotLibrary>> g_libraries;
+}
+
+std::shared_ptr<RobotLibrary> RobotLibrary::open(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(g_libraryMutex);
+
+    auto found = g_libraries.find(path);
+    if (found != g_libraries.end()) {
+        if (auto loaded = found->second.lock()) {
+            return loaded;
+        }
+    }
+
+    void* handle = dlopen(path.c_str(), RTLD_LAZY);
+    if (!handle) {
+        std::cerr << "Failed to load " << path
+                  << ": " << dlerror() << "\n";
+        return nullptr;
+    }
+
+    RobotFactory create_robot =
+        (RobotFactory)dlsym(handle, "create_robot");
+    if (!create_robot) {
+        std::cerr << "Failed to find create_robot in " << path
+                  << ": " << dlerror() << "\n";
+        dlclose(handle);
+        return nullptr;
+    }
+
+    std::shared_ptr<RobotLibrary> library(new RobotLibrary(handle, create_robot, path));
+    g_libraries[path] = library;
+    return library;
+}
+
+RobotLibrary::RobotLibrary(void* handle, RobotFactory factory, std::string path)
+    : m_handle(handle),
+      m_factory(factory),
+      m_path(std::move(path))
+{
+}
+
+RobotLibrary::~RobotLibrary()
+{
+    dlclose(m_handle);
+
+    std::lock_guard<std::mutex> lock(g_libraryMutex);
+    auto found = g_libraries.find(m_path);
+    if (found != g_libraries.end() && found->second.expired()) {
+        g_libraries.erase(found);
+    }
+}
+
+bool RobotLibrary::compile(const std::string& source, const std::string& sharedLib)
+{
+    std::string compileCmd =
+        "g++ -shared -fPIC -o " + sharedLib + " " + source +
+        " RobotBase.o -I. -std=c++20";
+
+    if (std::system(compileCmd.c_str()) != 0) {
+        std::cerr << "Failed to compile " << source
+                  << " with command: " << compileCmd << "\n";
+        return false;
+    }
+    return true;
+}
+
+size_t RobotLibrary::loadedCount()
+{
+    std::lock_guard<std::mutex> lock(g_libraryMutex);
+    size_t count = 0;
+    for (const auto& [path, library] : g_libraries) {
+        if (!library.expired()) ++count;
+    }
+    return count;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "RobotBase.h"
+
+// A dlopen'ed robot shared object. Each path is loaded at most once per
+// process: open() hands out shared references and the library is
+// dlclose'd when the last one goes away. Anything created through
+// factory() must be destroyed before that - RobotInfo and RegisteredRobot
+// hold a reference next to the robots they create.
+class RobotLibrary {
+public:
+    // Load path (or reuse it if already loaded) and look up create_robot.
+    // Prints the reason and returns nullptr on failure.
+    static std::shared_ptr<RobotLibrary> open(const std::string& path);
+
+    ~RobotLibrary();
+
+    RobotLibrary(const RobotLibrary&) = delete;
+    RobotLibrary& operator=(const RobotLibrary&) = delete;
+
+    RobotFactory       factory() const { return m_factory; }
+    const std::string& path() const { return m_path; }
+
+    // Build source (a Robot_*.cpp) into sharedLib the way the arena
+    // expects. Prints the command and returns false if g++ fails.
+    static bool compile(const std::string& source, const std::string& sharedLib);
+
+    // Libraries currently loaded in this process.
+    static size_t loadedCount();
+
+private:
+    RobotLibrary(void* handle, RobotFactory factory, std::string path);
+
+    void*        m_handle;
+    RobotFactory m_factory;
+    std::string  m_path;
+};
@@ -0,0 +1,399 @@
+#pragma once
+
+// Navigation helpers that robots can include next to RobotBase.h (which
+// stays frozen). Header-only, so a robot .so picks it up with no extra
+// link step:
+//
+//     #include "RobotNav.h"
+//     NavMap m_nav;
+//     ...
+//     m_nav.reset(m_board_row_max, m_board_col_max);   // once
+//     m_nav.observe(radar_results);                    // every turn
+//     if (m_nav.is_obstacle(r, c)) ...                 // O(1)
+//     m_nav.set_goal(enemy_row, enemy_col);
+//     int dir = m_nav.step_toward_goal(my_row, my_col);
+//
+// Everything is stored row-major in flat arrays: one bit per cell for each
+// terrain kind, and 16-bit distances. Whole-board operations are simple
+// loops over contiguous words that the compiler can vectorize.
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+#include "RobotBase.h"
+#include "RadarObj.h"
+
+// One bit per cell.
+class CellBits
+{
+public:
+    void reset(int cells)
+    {
+        m_words.assign((cells + 63) / 64, 0);
+    }
+
+    bool test(int cell) const
+    {
+        return (m_words[cell >> 6] >> (cell & 63)) & 1u;
+    }
+
+    // returns true if the bit was newly set
+    bool set(int cell)
+    {
+        uint64_t  bit  = uint64_t(1) << (cell & 63);
+        uint64_t& word = m_words[cell >> 6];
+        bool fresh = !(word & bit);
+        word |= bit;
+        return fresh;
+    }
+
+    const std::vector<uint64_t>& words() const { return m_words; }
+    std::vector<uint64_t>&       words()       { return m_words; }
+
+private:
+    std::vector<uint64_t> m_words;
+};
+
+class NavMap
+{
+public:
+    static constexpr uint16_t unreachable = 0xFFFF;
+
+    // Cost of stepping onto a flame trap when planning toward the goal,
+    // in plain steps. Pits are never planned through - they end the trip.
+    static constexpr int flamer_cost = 6;
+
+    void reset(int rows, int cols)
+    {
+        m_rows = rows;
+        m_cols = cols;
+        int cells = rows * cols;
+
+        m_mounds.reset(cells);
+        m_pits.reset(cells);
+        m_flamers.reset(cells);
+        m_dead.reset(cells);
+        m_blocked.reset(cells);
+
+        m_clearance.assign(cells, unreachable);
+        m_goal_dist.assign(cells, unreachable);
+        m_affected.assign(cells, 0);
+        m_changed.clear();
+        m_goal = -1;
+        m_goal_dirty = true;
+    }
+
+    // Learn terrain from a radar scan. Only cells that are new to the map
+    // do any work, so a turn costs O(radar results + changed cells).
+    // Returns the number of newly learned hazard cells.
+    int observe(const std::vector<RadarObj>& radar_results)
+    {
+        m_frontier.clear();
+
+        for (const auto& obj : radar_results) {
+            if (!in_bounds(obj.m_row, obj.m_col)) continue;
+            int cell = obj.m_row * m_cols + obj.m_col;
+
+            bool fresh = false;
+            switch (obj.m_type) {
+            case 'M': fresh = m_mounds.set(cell);  m_blocked.set(cell); break;
+            case 'X': fresh = m_dead.set(cell);    m_blocked.set(cell); break;
+            case 'P': fresh = m_pits.set(cell);    break;
+            case 'F':
+                // a flamer seen again changes nothing
+                if (m_flamers.set(cell)) m_changed.push_back(cell);
+                continue;
+            default:  continue;
+            }
+
+            if (fresh) {
+                m_changed.push_back(cell);
+                m_clearance[cell] = 0;
+                m_frontier.push_back(cell);
+            }
+        }
+
+        int learned = static_cast<int>(m_frontier.size());
+        spread_clearance();
+        return learned;
+    }
+
+    bool in_bounds(int r, int c) const
+    {
+        return r >= 0 && r < m_rows && c >= 0 && c < m_cols;
+    }
+
+    // Mounds and dead robots stop movement.
+    bool is_obstacle(int r, int c) const
+    {
+        return in_bounds(r, c) && m_blocked.test(r * m_cols + c);
+    }
+
+    bool is_pit(int r, int c) const    { return in_bounds(r, c) && m_pits.test(r * m_cols + c); }
+    bool is_flamer(int r, int c) const { return in_bounds(r, c) && m_flamers.test(r * m_cols + c); }
+
+    // Steps (8-connected) to the nearest known mound, pit or dead robot,
+    // or unreachable if none is known yet.
+    uint16_t clearance(int r, int c) const
+    {
+        return in_bounds(r, c) ? m_clearance[r * m_cols + c] : 0;
+    }
+
+    // Aim the goal field at (r, c). Distances are updated lazily: a new
+    // goal recomputes the field, new terrain only repairs the cells whose
+    // route it made longer.
+    void set_goal(int r, int c)
+    {
+        int cell = in_bounds(r, c) ? r * m_cols + c : -1;
+        if (cell != m_goal) {
+            m_goal = cell;
+            m_goal_dirty = true;
+        }
+    }
+
+    // Planning cost from (r, c) to the goal: steps, with flame traps
+    // charged flamer_cost and pits/obstacles impassable.
+    uint16_t goal_distance(int r, int c)
+    {
+        if (!in_bounds(r, c)) return unreachable;
+        refresh_goal_field();
+        return m_goal_dist[r * m_cols + c];
+    }
+
+    // Best direction (1-8) for one step toward the goal, or 0 if there is
+    // no goal or no neighbor gets closer.
+    int step_toward_goal(int r, int c)
+    {
+        if (!in_bounds(r, c)) return 0;
+        refresh_goal_field();
+
+        int      best_dir  = 0;
+        uint16_t best_dist = m_goal_dist[r * m_cols + c];
+        for (int dir = 1; dir <= 8; ++dir) {
+            int nr = r + directions[dir].first;
+            int nc = c + directions[dir].second;
+            if (!in_bounds(nr, nc)) continue;
+            uint16_t d = m_goal_dist[nr * m_cols + nc];
+            if (d < best_dist) {
+                best_dist = d;
+                best_dir  = dir;
+            }
+        }
+        return best_dir;
+    }
+
+    int rows() const { return m_rows; }
+    int cols() const { return m_cols; }
+
+private:
+    // Decrease-only BFS from newly learned hazards. Hazards never go away,
+    // so distances only shrink and we stop as soon as a cell doesn't
+    // improve - the work is proportional to the cells that changed.
+    void spread_clearance()
+    {
+        for (size_t head = 0; head < m_frontier.size(); ++head) {
+            int cell = m_frontier[head];
+            int r = cell / m_cols;
+            int c = cell % m_cols;
+            uint16_t next = m_clearance[cell] + 1;
+
+            for (int dir = 1; dir <= 8; ++dir) {
+                int nr = r + directions[dir].first;
+                int nc = c + directions[dir].second;
+                if (!in_bounds(nr, nc)) continue;
+                int n = nr * m_cols + nc;
+                if (m_clearance[n] > next) {
+                    m_clearance[n] = next;
+                    m_frontier.push_back(n);
+                }
+            }
+        }
+        m_frontier.clear();
+    }
+
+    bool passable(int cell) const
+    {
+        return cell == m_goal || !(m_blocked.test(cell) || m_pits.test(cell));
+    }
+
+    // Price of walking into cell from a neighbor.
+    int entry_cost(int cell) const
+    {
+        return m_flamers.test(cell) ? flamer_cost : 1;
+    }
+
+    void refresh_goal_field()
+    {
+        if (m_goal_dirty) {
+            m_goal_dirty = false;
+            m_changed.clear();
+            rebuild_goal_field();
+        } else if (!m_changed.empty()) {
+            repair_goal_field();
+        }
+    }
+
+    // New hazards only make routes longer. A cell keeps its distance if a
+    // neighbor that is not itself affected still offers it; the others
+    // (the changed cells and whatever routed through them) are cleared,
+    // seeded from their unaffected neighbors and settled again with
+    // Dijkstra, so the work is proportional to the affected cells.
+    void repair_goal_field()
+    {
+        std::vector<int> check;
+        std::vector<int> affected;
+        auto push_neighbors = [&](int cell) {
+            int r = cell / m_cols;
+            int c = cell % m_cols;
+            for (int dir = 1; dir <= 8; ++dir) {
+                int nr = r + directions[dir].first;
+                int nc = c + directions[dir].second;
+                if (in_bounds(nr, nc)) check.push_back(nr * m_cols + nc);
+            }
+        };
+
+        // the changed cells go first, so a new obstacle is known to be
+        // affected before any neighbor looks to it for support
+        check.swap(m_changed);
+        size_t changed = check.size();
+        for (size_t i = 0; i < check.size(); ++i) {
+            int cell = check[i];
+            if (i < changed) push_neighbors(cell);   // their entry cost may have risen
+            if (cell == m_goal || m_affected[cell] ||
+                m_goal_dist[cell] == unreachable) {
+                continue;
+            }
+
+            bool supported = false;
+            if (passable(cell)) {
+                int r = cell / m_cols;
+                int c = cell % m_cols;
+                for (int dir = 1; dir <= 8 && !supported; ++dir) {
+                    int nr = r + directions[dir].first;
+                    int nc = c + directions[dir].second;
+                    if (!in_bounds(nr, nc)) continue;
+                    int n = nr * m_cols + nc;
+                    supported = !m_affected[n] && passable(n) &&
+                                m_goal_dist[n] != unreachable &&
+                                m_goal_dist[n] + entry_cost(n) == m_goal_dist[cell];
+                }
+            }
+            if (supported) continue;
+
+            m_affected[cell] = 1;
+            affected.push_back(cell);
+            push_neighbors(cell);
+        }
+
+        using Entry = std::pair<int, int>;   // (distance, cell)
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+
+        for (int cell : affected) m_goal_dist[cell] = unreachable;
+        for (int cell : affected) {
+            if (!passable(cell)) continue;
+            int r = cell / m_cols;
+            int c = cell % m_cols;
+            int best = unreachable;
+            for (int dir = 1; dir <= 8; ++dir) {
+                int nr = r + directions[dir].first;
+                int nc = c + directions[dir].second;
+                if (!in_bounds(nr, nc)) continue;
+                int n = nr * m_cols + nc;
+                if (m_affected[n] || !passable(n) || m_goal_dist[n] == unreachable) continue;
+                best = std::min(best, m_goal_dist[n] + entry_cost(n));
+            }
+            if (best < unreachable) {
+                m_goal_dist[cell] = static_cast<uint16_t>(best);
+                queue.emplace(best, cell);
+            }
+        }
+        for (int cell : affected) m_affected[cell] = 0;
+
+        while (!queue.empty()) {
+            auto [cost, cell] = queue.top();
+            queue.pop();
+            if (m_goal_dist[cell] != cost) continue;   // stale entry
+
+            int r = cell / m_cols;
+            int c = cell % m_cols;
+            int d = cost + entry_cost(cell);
+            for (int dir = 1; dir <= 8; ++dir) {
+                int nr = r + directions[dir].first;
+                int nc = c + directions[dir].second;
+                if (!in_bounds(nr, nc)) continue;
+                int n = nr * m_cols + nc;
+                if (!passable(n) || d >= m_goal_dist[n]) continue;
+                m_goal_dist[n] = static_cast<uint16_t>(d);
+                queue.emplace(d, n);
+            }
+        }
+    }
+
+    // Dial's algorithm (bucketed Dijkstra) outward from the goal. Edge
+    // weights are 1 or flamer_cost, so a small ring of buckets suffices.
+    void rebuild_goal_field()
+    {
+        std::fill(m_goal_dist.begin(), m_goal_dist.end(), unreachable);
+        if (m_goal < 0) return;
+
+        for (auto& bucket : m_buckets) bucket.clear();
+        m_goal_dist[m_goal] = 0;
+        m_buckets[0].push_back(m_goal);
+
+        int pending = 1;
+        for (int cost = 0; pending > 0; ++cost) {
+            auto& bucket = m_buckets[cost % ring];
+            for (size_t i = 0; i < bucket.size(); ++i) {
+                int cell = bucket[i];
+                --pending;
+                if (m_goal_dist[cell] != cost) continue;   // stale entry
+
+                int r = cell / m_cols;
+                int c = cell % m_cols;
+                for (int dir = 1; dir <= 8; ++dir) {
+                    int nr = r + directions[dir].first;
+                    int nc = c + directions[dir].second;
+                    if (!in_bounds(nr, nc)) continue;
+                    int n = nr * m_cols + nc;
+                    // distances are "cost to walk from n to the goal", so
+                    // the price is paid for entering cell, not n
+                    if (m_blocked.test(n) || m_pits.test(n)) continue;
+
+                    int step = m_flamers.test(cell) ? flamer_cost : 1;
+                    int d    = cost + step;
+                    if (d < m_goal_dist[n]) {
+                        m_goal_dist[n] = static_cast<uint16_t>(d);
+                        m_buckets[d % ring].push_back(n);
+                        ++pending;
+                    }
+                }
+            }
+            bucket.clear();
+        }
+    }
+
+    static constexpr int ring = flamer_cost + 1;
+
+    int m_rows = 0;
+    int m_cols = 0;
+
+    CellBits m_mounds;
+    CellBits m_pits;
+    CellBits m_flamers;
+    CellBits m_dead;
+    CellBits m_blocked;   // mounds | dead robots
+
+    std::vector<uint16_t> m_clearance;
+    std::vector<int>      m_frontier;
+
+    int                   m_goal = -1;
+    bool                  m_goal_dirty = true;   // goal moved: rebuild the field
+    std::vector<int>      m_changed;             // terrain learned since: repair it
+    std::vector<uint8_t>  m_affected;
+    std::vector<uint16_t> m_goal_dist;
+    std::vector<int>      m_buckets[ring];
+};
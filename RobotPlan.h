@@ -0,0 +1,322 @@
+#pragma once
+
+// Lookahead helpers that robots can include next to RobotBase.h (which
+// stays frozen). Header-only like RobotNav.h, so nothing extra is linked
+// into the robot .so and robots that don't include it pay nothing:
+//
+//     #include "RobotPlan.h"
+//     PlanBoard m_seen;
+//     ...
+//     m_seen.reset(m_board_row_max, m_board_col_max);   // once
+//     m_seen.observe(radar_results);                    // every turn
+//
+//     PlanState now(m_seen);
+//     int me = now.add_self(*this);
+//     now.observe(radar_results);                       // enemies, wrecks
+//     for (int dir = 1; dir <= 8; ++dir) {
+//         PlanState next = now;                         // a plain copy
+//         next.move(me, dir, get_move_speed());
+//         ... score next, or search deeper ...
+//     }
+//
+// A PlanBoard holds the terrain the robot has seen and is only read while
+// planning. A PlanState points at it and keeps the robots in a fixed
+// array, so cloning is one small memcpy and no step ever allocates. Moves
+// and shots follow Arena::handleMovement and Arena::handleShot exactly
+// (pits end a move, mounds and robots - wrecks included - block it,
+// flame traps burn, the same weapon footprints and armor rules); only
+// the damage roll, which the arena draws at random, is fixed by a
+// PlanRoll.
+
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+
+#include "RobotBase.h"
+#include "RadarObj.h"
+
+// Terrain seen so far: '.', 'M', 'P' or 'F' per cell, row-major.
+class PlanBoard
+{
+public:
+    void reset(int rows, int cols)
+    {
+        m_rows = rows;
+        m_cols = cols;
+        m_cells.assign(static_cast<size_t>(rows) * cols, '.');
+    }
+
+    // Record the mounds, pits and flame traps in a radar scan. Robots and
+    // wrecks move or appear, so they belong in a PlanState instead.
+    void observe(const std::vector<RadarObj>& radar_results)
+    {
+        for (const auto& obj : radar_results) {
+            if (!in_bounds(obj.m_row, obj.m_col)) continue;
+            if (obj.m_type == 'M' || obj.m_type == 'P' || obj.m_type == 'F') {
+                m_cells[obj.m_row * m_cols + obj.m_col] = obj.m_type;
+            }
+        }
+    }
+
+    void set_terrain(int r, int c, char type)
+    {
+        if (in_bounds(r, c)) m_cells[r * m_cols + c] = type;
+    }
+
+    char terrain(int r, int c) const { return m_cells[r * m_cols + c]; }
+
+    bool in_bounds(int r, int c) const
+    {
+        return r >= 0 && r < m_rows && c >= 0 && c < m_cols;
+    }
+
+    int rows() const { return m_rows; }
+    int cols() const { return m_cols; }
+
+private:
+    int m_rows = 0;
+    int m_cols = 0;
+    std::vector<char> m_cells;
+};
+
+// One robot in a plan. Stats of other robots are whatever the planner
+// assumes; radar doesn't report them.
+struct PlanRobot
+{
+    int16_t row      = 0;
+    int16_t col      = 0;
+    int16_t health   = 100;
+    int16_t armor    = 0;
+    int8_t  move     = 2;    // 0 once stuck in a pit
+    int8_t  weapon   = railgun;
+    int16_t grenades = 0;
+    bool    alive    = true;
+    bool    in_pit   = false;
+};
+
+// Which damage the arena's random roll is taken to be.
+enum PlanRoll { roll_low, roll_mid, roll_high };
+
+class PlanState
+{
+public:
+    static constexpr int max_robots = 32;
+
+    explicit PlanState(const PlanBoard& board, PlanRoll roll = roll_mid)
+        : m_board(&board), m_roll(roll)
+    {
+    }
+
+    // Add a robot; returns its index, or -1 when the plan is full.
+    int add_robot(const PlanRobot& robot)
+    {
+        if (m_count == max_robots) return -1;
+        m_robots[m_count] = robot;
+        return m_count++;
+    }
+
+    // Add the calling robot with its real stats.
+    int add_self(RobotBase& self)
+    {
+        PlanRobot me;
+        int r = 0;
+        int c = 0;
+        self.get_current_location(r, c);
+        me.row      = static_cast<int16_t>(r);
+        me.col      = static_cast<int16_t>(c);
+        me.health   = static_cast<int16_t>(self.get_health());
+        me.armor    = static_cast<int16_t>(self.get_armor());
+        me.move     = static_cast<int8_t>(self.get_move_speed());
+        me.weapon   = static_cast<int8_t>(self.get_weapon());
+        me.grenades = static_cast<int16_t>(self.get_grenades());
+        me.alive    = me.health > 0;
+        return add_robot(me);
+    }
+
+    // Add every robot ('R', with the given assumed stats) and wreck ('X')
+    // in a radar scan that isn't in the plan yet.
+    void observe(const std::vector<RadarObj>& radar_results,
+                 const PlanRobot& assumed = PlanRobot())
+    {
+        for (const auto& obj : radar_results) {
+            if (obj.m_type != 'R' && obj.m_type != 'X') continue;
+            if (robot_at(obj.m_row, obj.m_col) >= 0) continue;
+
+            PlanRobot other = assumed;
+            other.row   = static_cast<int16_t>(obj.m_row);
+            other.col   = static_cast<int16_t>(obj.m_col);
+            other.alive = obj.m_type == 'R';
+            if (!other.alive) other.health = 0;
+            if (add_robot(other) < 0) return;
+        }
+    }
+
+    int              robot_count() const { return m_count; }
+    const PlanRobot& robot(int i) const  { return m_robots[i]; }
+    PlanRobot&       robot(int i)        { return m_robots[i]; }
+
+    // Index of the robot (or wreck) on r,c, or -1.
+    int robot_at(int r, int c) const
+    {
+        for (int i = 0; i < m_count; ++i) {
+            if (m_robots[i].row == r && m_robots[i].col == c) return i;
+        }
+        return -1;
+    }
+
+    int alive_count() const
+    {
+        int alive = 0;
+        for (int i = 0; i < m_count; ++i) {
+            alive += m_robots[i].alive;
+        }
+        return alive;
+    }
+
+    // As Arena::handleMovement. Returns the number of cells moved.
+    int move(int who, int direction, int distance)
+    {
+        PlanRobot& bot = m_robots[who];
+        if (!bot.alive || bot.in_pit || bot.move == 0) return 0;
+        if (direction < 1 || direction > 8) return 0;
+
+        if (distance > bot.move) distance = bot.move;
+        int dr = directions[direction].first;
+        int dc = directions[direction].second;
+
+        int moved = 0;
+        for (int step = 0; step < distance; ++step) {
+            int r = bot.row + dr;
+            int c = bot.col + dc;
+            if (!m_board->in_bounds(r, c) || robot_at(r, c) >= 0) break;
+
+            char cell = m_board->terrain(r, c);
+            if (cell == 'M') break;
+
+            bot.row = static_cast<int16_t>(r);
+            bot.col = static_cast<int16_t>(c);
+            ++moved;
+
+            if (cell == 'P') {
+                bot.in_pit = true;
+                bot.move   = 0;
+                break;
+            }
+            if (cell == 'F') {
+                damage(bot, flamethrower);
+                if (!bot.alive) break;
+            }
+        }
+        return moved;
+    }
+
+    // As Arena::handleShot, with the shooter's own weapon. Returns the
+    // damage dealt (which can include the shooter, e.g. a close grenade).
+    int shoot(int who, int shot_row, int shot_col)
+    {
+        PlanRobot& shooter = m_robots[who];
+        if (!shooter.alive) return 0;
+
+        WeaponType weapon = static_cast<WeaponType>(shooter.weapon);
+        if (weapon == grenade) {
+            if (shooter.grenades <= 0) return 0;
+            --shooter.grenades;
+        }
+
+        int sr = shooter.row;
+        int sc = shooter.col;
+        int dir = direction_toward(shot_row - sr, shot_col - sc);
+        int dealt = 0;
+
+        switch (weapon) {
+        case railgun:
+            if (dir == 0) return 0;
+            for (int r = sr + directions[dir].first, c = sc + directions[dir].second;
+                 m_board->in_bounds(r, c);
+                 r += directions[dir].first, c += directions[dir].second) {
+                dealt += damage_at(r, c, weapon);
+            }
+            break;
+
+        case hammer:
+            if (dir == 0) return 0;
+            dealt += damage_at(sr + directions[dir].first, sc + directions[dir].second, weapon);
+            break;
+
+        case flamethrower:
+        {
+            if (dir == 0) return 0;
+            int dr = directions[dir].first;
+            int dc = directions[dir].second;
+            for (int k = 1; k <= 4; ++k) {
+                int r = sr + dr * k;
+                int c = sc + dc * k;
+                if (!m_board->in_bounds(r, c)) break;
+                dealt += damage_at(r, c, weapon);
+                dealt += damage_at(r - dc, c + dr, weapon);   // the two side lanes
+                dealt += damage_at(r + dc, c - dr, weapon);
+            }
+            break;
+        }
+
+        case grenade:
+            if (!m_board->in_bounds(shot_row, shot_col)) return 0;
+            for (int r = shot_row - 1; r <= shot_row + 1; ++r) {
+                for (int c = shot_col - 1; c <= shot_col + 1; ++c) {
+                    dealt += damage_at(r, c, weapon);
+                }
+            }
+            break;
+        }
+        return dealt;
+    }
+
+    // The arena's direction (0-8) for a shot offset: only the signs count.
+    static int direction_toward(int dr, int dc)
+    {
+        if (dr < 0) return dc > 0 ? 2 : dc < 0 ? 8 : 1;
+        if (dr > 0) return dc > 0 ? 4 : dc < 0 ? 6 : 5;
+        return dc > 0 ? 3 : dc < 0 ? 7 : 0;
+    }
+
+private:
+    int damage_at(int r, int c, WeaponType weapon)
+    {
+        if (!m_board->in_bounds(r, c)) return 0;
+        int i = robot_at(r, c);
+        return i >= 0 ? damage(m_robots[i], weapon) : 0;
+    }
+
+    // As Arena::applyWeaponDamage, with the roll fixed by m_roll.
+    int damage(PlanRobot& target, WeaponType weapon)
+    {
+        if (!target.alive) return 0;
+
+        int low = 0;
+        int high = 0;
+        switch (weapon) {
+        case railgun:      low = 10; high = 20; break;
+        case hammer:       low = 50; high = 60; break;
+        case grenade:      low = 10; high = 40; break;
+        case flamethrower: low = 30; high = 50; break;
+        }
+        int raw = m_roll == roll_low ? low : m_roll == roll_high ? high : (low + high) / 2;
+
+        double reduction = target.armor * 0.10;
+        if (reduction > 0.9) reduction = 0.9;
+        int dealt = static_cast<int>(raw * (1.0 - reduction));
+
+        if (target.armor > 0) --target.armor;
+        target.health = static_cast<int16_t>(target.health > dealt ? target.health - dealt : 0);
+        if (target.health <= 0) target.alive = false;
+        return dealt;
+    }
+
+    const PlanBoard* m_board;
+    PlanRoll         m_roll;
+    int              m_count = 0;
+    PlanRobot        m_robots[max_robots];
+};
+
+static_assert(std::is_trivially_copyable_v<PlanState>,
+              "PlanState clones must stay a plain copy");
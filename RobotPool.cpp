@@ -0,0 +1,599 @@
+#include "RobotPool.h"
+#include "TurnPipeline.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <csignal>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+// Messages between a ProcessRobot and its worker, one per SEQPACKET
+// datagram. A request carries the arena's view of the robot so the
+// worker's copy matches it before each callback; ProcessRadar appends
+// radarCount RadarObjs.
+enum Op : uint32_t {
+    Hello, Create, Destroy,
+    RadarDirection, ProcessRadar, ShotLocation, MoveDirection
+};
+
+struct PoolRequest {
+    uint32_t op;
+    int32_t  row, col;
+    int32_t  health, armor, move, grenades;
+    int32_t  rowMax, colMax;
+    uint32_t reseed;      // if set, std::srand(randSeed) first
+    uint32_t randSeed;
+    uint32_t radarCount;
+};
+
+struct PoolReply {
+    int32_t  ok;
+    int32_t  values[2];   // the callback's outputs
+    int32_t  move, armor, weapon;
+    char     symbol;
+    char     name[32];
+    int64_t  rssKb;       // Hello and Destroy
+};
+
+long residentKb()
+{
+    std::ifstream statm("/proc/self/statm");
+    long pages = 0, resident = 0;
+    if (!(statm >> pages >> resident)) return 0;
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+// Bring the worker's robot in line with the arena's view. Within a match
+// health, armor, grenades and move speed only go down.
+void sync(RobotBase& robot, const PoolRequest& req)
+{
+    robot.set_boundaries(req.rowMax, req.colMax);
+    robot.move_to(req.row, req.col);
+    if (robot.get_health() > req.health) robot.take_damage(robot.get_health() - req.health);
+    if (robot.get_armor() > req.armor)   robot.reduce_armor(robot.get_armor() - req.armor);
+    while (robot.get_grenades() > req.grenades) robot.decrement_grenades();
+    if (req.move == 0 && robot.get_move_speed() != 0) robot.disable_movement();
+}
+
+[[noreturn]] void workerMain(int fd, RobotFactory factory)
+{
+    std::unique_ptr<RobotBase> robot;
+    std::vector<unsigned char> message;
+    std::vector<RadarObj>      radar;
+
+    for (;;) {
+        // size the buffer to the datagram before taking it
+        ssize_t size = recv(fd, nullptr, 0, MSG_PEEK | MSG_TRUNC);
+        if (size < static_cast<ssize_t>(sizeof(PoolRequest))) _exit(0);
+        message.resize(static_cast<size_t>(size));
+        if (recv(fd, message.data(), message.size(), 0) != size) _exit(0);
+
+        PoolRequest req;
+        std::memcpy(&req, message.data(), sizeof(req));
+        PoolReply reply{};
+        reply.ok = 1;
+
+        try {
+            if (req.op >= RadarDirection) {
+                if (!robot) _exit(1);
+                sync(*robot, req);
+            }
+            if (req.reseed) std::srand(req.randSeed);
+
+            switch (req.op) {
+            case Hello:
+                reply.rssKb = residentKb();
+                break;
+            case Create:
+                robot.reset(factory());
+                if (!robot) {
+                    reply.ok = 0;
+                    break;
+                }
+                reply.move   = robot->get_move_speed();
+                reply.armor  = robot->get_armor();
+                reply.weapon = robot->get_weapon();
+                reply.symbol = robot->m_character;
+                robot->m_name.copy(reply.name, sizeof(reply.name) - 1);
+                break;
+            case Destroy:
+                robot.reset();
+                reply.rssKb = residentKb();
+                break;
+            case RadarDirection:
+                robot->get_radar_direction(reply.values[0]);
+                break;
+            case ProcessRadar:
+                if (message.size() != sizeof(req) + req.radarCount * sizeof(RadarObj)) _exit(1);
+                radar.resize(req.radarCount);
+                std::memcpy(static_cast<void*>(radar.data()), message.data() + sizeof(req),
+                            req.radarCount * sizeof(RadarObj));
+                robot->process_radar_results(radar);
+                break;
+            case ShotLocation:
+                reply.ok = robot->get_shot_location(reply.values[0], reply.values[1]);
+                break;
+            case MoveDirection:
+                robot->get_move_direction(reply.values[0], reply.values[1]);
+                break;
+            default:
+                _exit(1);
+            }
+        }
+        catch (...) {
+            _exit(1);   // the pool sees a crash
+        }
+
+        if (send(fd, &reply, sizeof(reply), MSG_NOSIGNAL) != sizeof(reply)) _exit(0);
+    }
+}
+
+bool sendFd(int socket, int fd, pid_t pid)
+{
+    msghdr msg{};
+    iovec  iov{&pid, sizeof(pid)};
+    msg.msg_iov    = &iov;
+    msg.msg_iovlen = 1;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    if (fd >= 0) {
+        msg.msg_control    = control;
+        msg.msg_controllen = sizeof(control);
+        cmsghdr* cmsg   = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type  = SCM_RIGHTS;
+        cmsg->cmsg_len   = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+    return sendmsg(socket, &msg, MSG_NOSIGNAL) == static_cast<ssize_t>(sizeof(pid));
+}
+
+int recvFd(int socket, pid_t& pid)
+{
+    msghdr msg{};
+    iovec  iov{&pid, sizeof(pid)};
+    msg.msg_iov    = &iov;
+    msg.msg_iovlen = 1;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    msg.msg_control    = control;
+    msg.msg_controllen = sizeof(control);
+
+    if (recvmsg(socket, &msg, MSG_CMSG_CLOEXEC) != static_cast<ssize_t>(sizeof(pid))) return -1;
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if (!cmsg || cmsg->cmsg_type != SCM_RIGHTS) return -1;
+
+    int fd;
+    std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    return fd;
+}
+
+// Forks a worker for each byte it reads and sends back its socket.
+[[noreturn]] void spawnerMain(int control, RobotFactory factory)
+{
+    // the caller's other descriptors (other pools, results, sockets)
+    // must not be held open by the workers
+    if (control != 3) {
+        dup2(control, 3);
+        control = 3;
+    }
+    close_range(4, ~0u, 0);
+
+    std::signal(SIGCHLD, SIG_IGN);   // workers are reaped automatically
+
+    for (;;) {
+        char request;
+        if (recv(control, &request, 1, 0) <= 0) _exit(0);
+
+        int   pair[2];
+        pid_t pid = -1;
+        if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, pair) == 0) {
+            pid = fork();
+            if (pid == 0) {
+                close(control);
+                close(pair[0]);
+                std::signal(SIGCHLD, SIG_DFL);
+                workerMain(pair[1], factory);
+            }
+            close(pair[1]);
+        } else {
+            pair[0] = -1;
+        }
+
+        sendFd(control, pid > 0 ? pair[0] : -1, pid);
+        if (pair[0] >= 0) close(pair[0]);
+    }
+}
+
+using Clock = std::chrono::steady_clock;
+
+int millisUntil(Clock::time_point deadline)
+{
+    auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - Clock::now()).count();
+    return left > 0 ? static_cast<int>(left) : 0;
+}
+
+// Wait for the worker's reply until deadline. False if it died or is late.
+bool receive(int fd, PoolReply& reply, Clock::time_point deadline)
+{
+    for (;;) {
+        pollfd ready{fd, POLLIN, 0};
+        int n = poll(&ready, 1, millisUntil(deadline));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+
+        ssize_t got = recv(fd, &reply, sizeof(reply), MSG_DONTWAIT);
+        if (got < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+        return got == static_cast<ssize_t>(sizeof(reply));
+    }
+}
+
+bool call(int fd, const void* request, size_t bytes, PoolReply& reply, int timeoutMs)
+{
+    if (send(fd, request, bytes, MSG_NOSIGNAL) != static_cast<ssize_t>(bytes)) return false;
+    return receive(fd, reply, Clock::now() + std::chrono::milliseconds(timeoutMs));
+}
+
+std::mutex               g_slotMutex;
+std::weak_ptr<RobotPool> g_slots[RobotPool::maxPools];
+}
+
+// The arena's side of a pooled robot (see RobotPool.h).
+class ProcessRobot : public RobotBase, public AsyncRobot
+{
+public:
+    ProcessRobot(std::shared_ptr<RobotPool> pool, RobotPool::Worker worker,
+                 const PoolReply& made)
+        : RobotBase(made.move, made.armor, static_cast<WeaponType>(made.weapon)),
+          m_pool(std::move(pool)), m_worker(worker)
+    {
+        m_name      = std::string(made.name, strnlen(made.name, sizeof(made.name)));
+        m_character = made.symbol;
+    }
+
+    ~ProcessRobot() override
+    {
+        if (m_pending) wait();
+
+        PoolRequest req{};
+        req.op = Destroy;
+        PoolReply reply{};
+        bool healthy = !m_crashed && call(m_worker.fd, &req, sizeof(req), reply,
+                                          m_pool->m_options.callTimeoutMs);
+        m_pool->release(m_worker, healthy, healthy ? reply.rssKb : 0);
+    }
+
+    void begin_call(Call which, const std::vector<RadarObj>* radar) override
+    {
+        m_answer = PoolReply{};
+        if (m_crashed) return;
+
+        // AsyncRobot's Call names hide the Op ones in here
+        static const uint32_t ops[] = {Op::RadarDirection, Op::ProcessRadar,
+                                       Op::ShotLocation, Op::MoveDirection};
+        PoolRequest req{};
+        req.op = ops[which];
+        get_current_location(req.row, req.col);
+        req.health   = get_health();
+        req.armor    = get_armor();
+        req.move     = get_move_speed();
+        req.grenades = get_grenades();
+        req.rowMax   = m_board_row_max;
+        req.colMax   = m_board_col_max;
+        if (!m_seeded) {
+            // the arena pinned std::rand() to the match seed before the
+            // first turn, so this draw is as reproducible as the match
+            req.reseed   = 1;
+            req.randSeed = static_cast<uint32_t>(std::rand());
+            m_seeded     = true;
+        }
+
+        m_request.resize(sizeof(req));
+        if (radar) {
+            req.radarCount = static_cast<uint32_t>(radar->size());
+            m_request.resize(sizeof(req) + radar->size() * sizeof(RadarObj));
+            std::memcpy(m_request.data() + sizeof(req), radar->data(),
+                        radar->size() * sizeof(RadarObj));
+        }
+        std::memcpy(m_request.data(), &req, sizeof(req));
+
+        if (send(m_worker.fd, m_request.data(), m_request.size(), MSG_NOSIGNAL) !=
+            static_cast<ssize_t>(m_request.size())) {
+            crashed();
+            return;
+        }
+        m_pending  = true;
+        m_deadline = Clock::now() + std::chrono::milliseconds(m_pool->m_options.callTimeoutMs);
+    }
+
+    bool finished() override
+    {
+        if (!m_pending) return true;
+        ssize_t n = recv(m_worker.fd, &m_answer, sizeof(m_answer), MSG_DONTWAIT);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            if (Clock::now() < m_deadline) return false;
+            crashed();   // hung
+            return true;
+        }
+        complete(n);
+        return true;
+    }
+
+    void wait() override
+    {
+        if (!m_pending) return;
+        if (receive(m_worker.fd, m_answer, m_deadline)) {
+            m_pending = false;
+        } else {
+            crashed();
+        }
+    }
+
+    int ready_fd() const override { return m_worker.fd; }
+
+    int timeout_ms() const override { return m_pending ? millisUntil(m_deadline) : -1; }
+
+    void get_radar_direction(int& radar_direction) override
+    {
+        radar_direction = m_crashed ? 1 : m_answer.values[0];
+    }
+
+    void process_radar_results(const std::vector<RadarObj>&) override {}
+
+    bool get_shot_location(int& shot_row, int& shot_col) override
+    {
+        shot_row = m_answer.values[0];
+        shot_col = m_answer.values[1];
+        return !m_crashed && m_answer.ok;
+    }
+
+    void get_move_direction(int& direction, int& distance) override
+    {
+        direction = m_answer.values[0];
+        distance  = m_answer.values[1];
+    }
+
+private:
+    void complete(ssize_t n)
+    {
+        m_pending = false;
+        if (n != static_cast<ssize_t>(sizeof(m_answer))) crashed();
+    }
+
+    // The worker died or missed its deadline. Kill it in case it is only
+    // stuck; the pool replaces it when the robot is deleted.
+    void crashed()
+    {
+        if (!m_crashed) {
+            bool late = m_pending && Clock::now() >= m_deadline;
+            std::cerr << m_pool->source() << " worker " << m_worker.pid
+                      << (late ? " did not answer in time" : " died")
+                      << "; its robot sits out the match.\n";
+            if (m_worker.pid > 0) ::kill(m_worker.pid, SIGKILL);
+        }
+        m_crashed = true;
+        m_pending = false;
+        m_answer  = PoolReply{};
+    }
+
+    std::shared_ptr<RobotPool> m_pool;
+    RobotPool::Worker          m_worker;
+    std::vector<unsigned char> m_request;
+    PoolReply                  m_answer{};
+    Clock::time_point          m_deadline;
+    bool                       m_pending = false;
+    bool                       m_crashed = false;
+    bool                       m_seeded  = false;
+};
+
+template <size_t N>
+RobotBase* RobotPool::createPooled()
+{
+    std::shared_ptr<RobotPool> pool;
+    {
+        std::lock_guard<std::mutex> lock(g_slotMutex);
+        pool = g_slots[N].lock();
+    }
+    return pool ? pool->create() : nullptr;
+}
+
+RobotFactory RobotPool::factoryFor(size_t slot)
+{
+    static const auto factories = []<size_t... N>(std::index_sequence<N...>) {
+        return std::vector<RobotFactory>{&RobotPool::createPooled<N>...};
+    }(std::make_index_sequence<maxPools>{});
+    return factories[slot];
+}
+
+std::shared_ptr<RobotPool> RobotPool::start(const RegisteredRobot& robot,
+                                            const RobotPoolOptions& options)
+{
+    std::lock_guard<std::mutex> slotLock(g_slotMutex);
+    size_t slot = 0;
+    while (slot < maxPools && !g_slots[slot].expired()) ++slot;
+    if (slot == maxPools) {
+        throw std::runtime_error("Too many robot pools (at most " + std::to_string(maxPools) + ")");
+    }
+
+    // anything still buffered would be written again by the children
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+
+    int control[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, control) != 0) {
+        throw std::runtime_error("Cannot create a socket for the " + robot.source + " pool");
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(control[0]);
+        close(control[1]);
+        throw std::runtime_error("Cannot fork the " + robot.source + " pool");
+    }
+    if (pid == 0) {
+        close(control[0]);
+        spawnerMain(control[1], robot.factory);
+    }
+    close(control[1]);
+
+    std::shared_ptr<RobotPool> pool(new RobotPool(robot, options, control[0], pid, slot));
+    g_slots[slot] = pool;
+
+    std::lock_guard<std::mutex> lock(pool->m_mutex);
+    for (int i = 0; i < options.prefork; ++i) {
+        pool->m_idle.push_back(pool->spawn());
+    }
+    return pool;
+}
+
+RobotPool::RobotPool(const RegisteredRobot& robot, const RobotPoolOptions& options,
+                     int spawner, pid_t spawnerPid, size_t slot)
+    : m_robot(robot), m_options(options),
+      m_spawner(spawner), m_spawnerPid(spawnerPid), m_slot(slot)
+{
+}
+
+RobotPool::~RobotPool()
+{
+    for (const auto& worker : m_idle) {
+        retire(worker, false);
+    }
+    close(m_spawner);   // the spawner exits on EOF
+    waitpid(m_spawnerPid, nullptr, 0);
+}
+
+RegisteredRobot RobotPool::entry() const
+{
+    return RegisteredRobot{m_robot.source, factoryFor(m_slot), m_robot.library};
+}
+
+RobotPoolStats RobotPool::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+RobotBase* RobotPool::create()
+{
+    // an idle worker may have died since it was used; try a fresh one
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        Worker worker = lease();
+
+        // constructors that draw std::rand() get the same numbers
+        // whichever worker they land in
+        PoolRequest req{};
+        req.op       = Create;
+        req.reseed   = 1;
+        req.randSeed = static_cast<uint32_t>(std::rand());
+        PoolReply reply{};
+        if (!call(worker.fd, &req, sizeof(req), reply, m_options.callTimeoutMs)) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_stats.crashed;
+            retire(worker, true);
+            continue;
+        }
+        if (!reply.ok) {
+            release(worker, true, worker.baseRssKb);
+            return nullptr;   // create_robot() returned nullptr
+        }
+        return new ProcessRobot(shared_from_this(), worker, reply);
+    }
+    throw std::runtime_error("Workers for " + m_robot.source + " keep dying on creation");
+}
+
+RobotPool::Worker RobotPool::lease()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_idle.empty()) return spawn();
+
+    Worker worker = m_idle.back();
+    m_idle.pop_back();
+    return worker;
+}
+
+void RobotPool::release(Worker worker, bool healthy, long rssKb)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.matches;
+    if (!healthy) {
+        ++m_stats.crashed;
+        retire(worker, true);
+        return;
+    }
+
+    ++worker.matches;
+    bool grown = m_options.recycleGrowthKb > 0 &&
+                 rssKb - worker.baseRssKb > m_options.recycleGrowthKb;
+    if (worker.matches < m_options.recycleAfter && !grown) {
+        m_idle.push_back(worker);
+        return;
+    }
+
+    ++m_stats.recycled;
+    retire(worker, false);
+    try {
+        m_idle.push_back(spawn());
+    }
+    catch (const std::exception&) {
+        // the next lease() tries again
+    }
+}
+
+RobotPool::Worker RobotPool::spawn()
+{
+    Worker worker;
+    char request = 1;
+    if (send(m_spawner, &request, 1, MSG_NOSIGNAL) == 1) {
+        worker.fd = recvFd(m_spawner, worker.pid);
+    }
+    if (worker.fd < 0) {
+        throw std::runtime_error("Cannot start a worker process for " + m_robot.source);
+    }
+
+    PoolRequest req{};
+    req.op = Hello;
+    PoolReply reply{};
+    if (!call(worker.fd, &req, sizeof(req), reply, m_options.callTimeoutMs)) {
+        retire(worker, true);
+        throw std::runtime_error("A new worker for " + m_robot.source + " died at once");
+    }
+    worker.baseRssKb = static_cast<long>(reply.rssKb);
+    ++m_stats.started;
+    return worker;
+}
+
+void RobotPool::retire(const Worker& worker, bool kill)
+{
+    // a healthy worker exits when its socket closes; one that misbehaved
+    // may be stuck, so make sure
+    if (kill && worker.pid > 0) ::kill(worker.pid, SIGKILL);
+    close(worker.fd);
+}
+
+std::vector<RegisteredRobot> poolRoster(const std::vector<RegisteredRobot>& roster,
+                                        const RobotPoolOptions& options,
+                                        std::vector<std::shared_ptr<RobotPool>>& pools)
+{
+    std::map<std::string, RegisteredRobot> pooled;
+    std::vector<RegisteredRobot> result;
+    for (const auto& robot : roster) {
+        auto found = pooled.find(robot.source);
+        if (found == pooled.end()) {
+            pools.push_back(RobotPool::start(robot, options));
+            found = pooled.emplace(robot.source, pools.back()->entry()).first;
+        }
+        result.push_back(found->second);
+    }
+    return result;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+#include "RobotRegistry.h"
+
+// Pre-forked robot processes
+// --------------------------
+// A RobotPool runs one robot type's code in long-lived worker processes,
+// so a robot that crashes, hangs its process or corrupts memory takes
+// only its worker down, not the arena: every request to a worker has a
+// deadline (callTimeoutMs), and a worker that misses it is killed. Workers are forked once and host
+// one robot after another: the arena's factory call leases an idle worker
+// and has it create_robot() there, and when the match is over the robot
+// is deleted in the worker, which goes back to the pool. A worker that has
+// hosted recycleAfter matches, or whose RSS grew more than recycleGrowthKb
+// since it started, is replaced by a fresh one.
+//
+// Each pool first forks a small single-threaded spawner, while the caller
+// is still single-threaded; workers are forked from that spawner on
+// demand (even from BatchRunner threads) and their socket is passed back
+// over a unix socket. A worker is an image of the caller at the time the
+// pool started, so robot libraries need no reloading.
+//
+// In the arena a pooled robot is a ProcessRobot: a RobotBase that keeps
+// the arena's view of the robot (health, armor, position, ...) and an
+// AsyncRobot that forwards each callback, with that state, to its worker
+// over a SOCK_SEQPACKET socket. While one worker thinks, a TurnScheduler
+// plays the other --batch lanes. If a worker dies, or is killed for
+// missing a deadline, the robot sits out the rest of its match (no radar,
+// shots or moves) and the worker is replaced.
+//
+// Robots draw std::rand() in their worker. It is seeded from the arena's
+// generator at the robot's first callback of each match, so results stay
+// reproducible per seed under the BatchRunner rules.
+
+struct RobotPoolOptions {
+    int      prefork         = 2;     // workers started up front
+    uint32_t recycleAfter    = 500;   // matches a worker hosts before it is replaced
+    long     recycleGrowthKb = 0;     // also replace a worker whose RSS grew more (0: never)
+    int      callTimeoutMs   = 2000;  // a worker slower than this to answer is killed
+};
+
+struct RobotPoolStats {
+    uint64_t started  = 0;   // workers forked
+    uint64_t recycled = 0;   // replaced after recycleAfter matches or RSS growth
+    uint64_t crashed  = 0;   // died or was killed while hosting a robot
+    uint64_t matches  = 0;   // robots hosted
+};
+
+class RobotPool : public std::enable_shared_from_this<RobotPool> {
+public:
+    // Fork the spawner and options.prefork workers for robot. Call before
+    // starting threads. Throws if the processes can't be started or too
+    // many pools are open.
+    static std::shared_ptr<RobotPool> start(const RegisteredRobot& robot,
+                                            const RobotPoolOptions& options);
+    ~RobotPool();
+
+    RobotPool(const RobotPool&) = delete;
+    RobotPool& operator=(const RobotPool&) = delete;
+
+    // robot with a factory that creates ProcessRobots on this pool. Keep
+    // the pool while the entry is in use; the robots it made hold their
+    // own reference.
+    RegisteredRobot entry() const;
+
+    const std::string& source() const { return m_robot.source; }
+    RobotPoolStats     stats() const;
+
+    // Pools that can be open at once.
+    static constexpr size_t maxPools = 32;
+
+private:
+    friend class ProcessRobot;
+
+    struct Worker {
+        int      fd        = -1;
+        pid_t    pid       = -1;
+        uint32_t matches   = 0;
+        long     baseRssKb = 0;
+    };
+
+    RobotPool(const RegisteredRobot& robot, const RobotPoolOptions& options,
+              int spawner, pid_t spawnerPid, size_t slot);
+
+    RobotBase* create();
+    Worker     lease();
+    void       release(Worker worker, bool healthy, long rssKb);
+    Worker     spawn();   // with m_mutex held
+    void       retire(const Worker& worker, bool kill);
+
+    // entry()'s factory is a plain function pointer, so each open pool
+    // gets a slot and one of maxPools factories that look the slot up.
+    template <size_t N>
+    static RobotBase*   createPooled();
+    static RobotFactory factoryFor(size_t slot);
+
+    RegisteredRobot  m_robot;
+    RobotPoolOptions m_options;
+    int              m_spawner;
+    pid_t            m_spawnerPid;
+    size_t           m_slot;
+
+    mutable std::mutex  m_mutex;
+    std::vector<Worker> m_idle;
+    RobotPoolStats      m_stats;
+};
+
+// roster with each robot replaced by its pooled entry; starts one pool per
+// source and adds it to pools.
+std::vector<RegisteredRobot> poolRoster(const std::vector<RegisteredRobot>& roster,
+                                        const RobotPoolOptions& options,
+                                        std::vector<std::shared_ptr<RobotPool>>& pools);
@@ -0,0 +1,9 @@
+#include "RobotRegistry.h"
+
+// Default registry: no robots are linked in, so Arena::loadRobots()
+// falls back to compiling and dlopen'ing Robot_*.cpp at runtime.
+const std::vector<RegisteredRobot>& registeredRobots()
+{
+    static const std::vector<RegisteredRobot> robots;
+    return robots;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "RobotBase.h"
+#include "RobotLibrary.h"
+
+// A robot type: its source file stem ("Robot_Ratboy") and factory. For a
+// robot loaded from a shared object, library keeps that object loaded for
+// as long as this entry exists; robots linked into the executable have no
+// library.
+struct RegisteredRobot {
+    std::string  source;
+    RobotFactory factory;
+
+    std::shared_ptr<RobotLibrary> library;
+};
+
+// Robots built into this binary, sorted by source name. Empty in the
+// normal build (RobotRegistry.cpp); the static build links a generated
+// RobotRegistry_gen.cpp instead.
+const std::vector<RegisteredRobot>& registeredRobots();
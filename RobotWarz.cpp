@@ -1,18 +1,484 @@
 // RobotWarz.cpp
 #include "Arena.h"
+#include "Trace.h"
+#include "BatchRunner.h"
+#include "RobotWatcher.h"
+#include "BoardScan.h"
+#include "WorkQueue.h"
+#include "RobotPool.h"
+#include "Sweep.h"
 #include <iostream>
+#include <string>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <unistd.h>
 
-int main() {
+namespace {
+void usage(const char* prog)
+{
+    std::cerr << "Usage: " << prog << " [--seed N] [--matches K] [--quiet] [--results FILE]\n"
+              << "       [--trace FILE] [--perf] [--threads N] [--batch W]\n"
+              << "       [--soak MAX_KB] [--watch] [--scan-kernel K] [--check-scan]\n"
+              << "       [--maps PACK] [--spectate NAME] [--replay FILE] [--heap-cap KB]\n"
+              << "       [--robot-pool N] [--recycle-after M] [--recycle-growth KB]\n"
+              << "       [--pool-timeout MS]\n"
+              << "       [--sweep AXES --sweep-out FILE]\n"
+              << "       [--coordinator ADDR [--work-batch N] | --worker ADDR]\n"
+              << "  --seed N     seed the map, spawns and damage rolls; matches\n"
+              << "               use seeds N, N+1, ... so two runs are paired\n"
+              << "  --matches K  play K matches on the same roster\n"
+              << "  --quiet      don't print the board or turn log\n"
+              << "  --results F  append a record per match to results file F\n"
+              << "               (summarize it with rwquery)\n"
+              << "  --trace F    record a timeline of rounds, robot callbacks and\n"
+              << "               arena phases to F as Chrome trace JSON (Perfetto)\n"
+              << "  --perf       report hardware counters per arena phase and robot\n"
+              << "               (single-threaded runs)\n"
+              << "  --threads N  play the matches on N threads\n"
+              << "  --batch W    advance W arenas in lockstep per thread, reusing\n"
+              << "               their memory between matches\n"
+              << "  --soak K     print RSS every 10% of the matches instead of one\n"
+              << "               line per match; exit 2 if it grows more than K kB\n"
+              << "               after the first 10%\n"
+              << "  --watch      rebuild a robot when its source changes, swap it\n"
+              << "               in at the next match, and replay the matches\n"
+              << "               after each change\n"
+              << "  --scan-kernel K  use board scan kernel scalar, sse2 or avx2\n"
+              << "               instead of the best one this CPU supports\n"
+              << "  --check-scan compare every board scan kernel against the\n"
+              << "               scalar one on random runs and exit\n"
+              << "  --maps PACK  play the maps of a pack built by rwmapgen (map\n"
+              << "               seed % count); the board size comes from the pack\n"
+              << "  --spectate NAME  publish every turn to shared memory feed NAME\n"
+              << "               for rwspectate viewers (single-threaded runs)\n"
+              << "  --replay F   record every turn to replay file F for\n"
+              << "               rwspectate --replay (single-threaded runs)\n"
+              << "  --heap-cap KB  a robot holding more than KB kB of heap after\n"
+              << "               one of its callbacks forfeits (results record\n"
+              << "               each robot's peak either way)\n"
+              << "  --robot-pool N  run each robot type in worker processes, N of\n"
+              << "               them forked up front, so a crash only loses its match\n"
+              << "  --recycle-after M  replace a pool worker after M matches (500)\n"
+              << "  --recycle-growth KB  also replace one whose RSS grew by KB kB\n"
+              << "  --pool-timeout MS  kill a pool worker that takes longer than MS\n"
+              << "               to answer one call (2000); its robot sits out\n"
+              << "  --sweep AXES  play --matches seeded matches on every point of a\n"
+              << "               grid of rules, e.g. size=20:40:10,mounds=0:10:5 (axes:\n"
+              << "               rows cols size mounds pits flamers maxRounds), and\n"
+              << "               append each point's aggregates to --sweep-out FILE;\n"
+              << "               points already in FILE are skipped\n"
+              << "  --coordinator ADDR  hand the matches out to workers in batches\n"
+              << "               of N seeds (default 100) on unix:/path or host:port\n"
+              << "               and collect their results\n"
+              << "  --worker ADDR  play batches for the coordinator at ADDR using\n"
+              << "               --threads and --batch, until it is done\n";
+}
+
+// Resident set size of this process in kB, or 0 if /proc isn't there.
+long residentKb()
+{
+    std::ifstream statm("/proc/self/statm");
+    long pages = 0, resident = 0;
+    if (!(statm >> pages >> resident)) return 0;
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+}
+
+int main(int argc, char* argv[]) {
     // For now, hard-code a 20x20 arena.
     // Later you can read these from a config file.
     int rows = 20;
     int cols = 20;
 
+    bool     seeded  = false;
+    uint32_t seed    = 0;
+    int      matches = 1;
+    bool     quiet   = false;
+    std::string resultsPath;
+    std::string tracePath;
+    bool     perf    = false;
+    int      threads = 1;
+    int      batch   = 1;
+    long     soakKb  = -1;
+    bool     watch   = false;
+    std::string mapsPath;
+    std::string feedName;
+    std::string replayPath;
+    uint32_t    heapCapKb = 0;
+    bool        pooled    = false;
+    RobotPoolOptions poolOptions;
+    std::string sweepSpec;
+    std::string sweepPath;
+    std::string coordinatorAddr;
+    std::string workerAddr;
+    int         workBatch = 100;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc) {
+            seed   = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            seeded = true;
+        } else if (arg == "--matches" && i + 1 < argc) {
+            matches = std::atoi(argv[++i]);
+        } else if (arg == "--quiet") {
+            quiet = true;
+        } else if (arg == "--results" && i + 1 < argc) {
+            resultsPath = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (arg == "--perf") {
+            perf = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (arg == "--batch" && i + 1 < argc) {
+            batch = std::atoi(argv[++i]);
+        } else if (arg == "--soak" && i + 1 < argc) {
+            soakKb = std::atol(argv[++i]);
+        } else if (arg == "--watch") {
+            watch = true;
+        } else if (arg == "--scan-kernel" && i + 1 < argc) {
+            std::string name = argv[++i];
+            int k = 0;
+            while (k < BoardScan::NumKernels &&
+                   name != BoardScan::kernelName(static_cast<BoardScan::Kernel>(k))) {
+                ++k;
+            }
+            if (k == BoardScan::NumKernels ||
+                !BoardScan::useKernel(static_cast<BoardScan::Kernel>(k))) {
+                std::cerr << "Board scan kernel " << name << " is not available.\n";
+                return 1;
+            }
+        } else if (arg == "--coordinator" && i + 1 < argc) {
+            coordinatorAddr = argv[++i];
+        } else if (arg == "--worker" && i + 1 < argc) {
+            workerAddr = argv[++i];
+        } else if (arg == "--work-batch" && i + 1 < argc) {
+            workBatch = std::atoi(argv[++i]);
+        } else if (arg == "--spectate" && i + 1 < argc) {
+            feedName = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (arg == "--heap-cap" && i + 1 < argc) {
+            heapCapKb = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--robot-pool" && i + 1 < argc) {
+            poolOptions.prefork = std::atoi(argv[++i]);
+            pooled = true;
+        } else if (arg == "--recycle-after" && i + 1 < argc) {
+            poolOptions.recycleAfter = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--recycle-growth" && i + 1 < argc) {
+            poolOptions.recycleGrowthKb = std::atol(argv[++i]);
+        } else if (arg == "--pool-timeout" && i + 1 < argc) {
+            poolOptions.callTimeoutMs = std::atoi(argv[++i]);
+        } else if (arg == "--sweep" && i + 1 < argc) {
+            sweepSpec = argv[++i];
+        } else if (arg == "--sweep-out" && i + 1 < argc) {
+            sweepPath = argv[++i];
+        } else if (arg == "--maps" && i + 1 < argc) {
+            mapsPath = argv[++i];
+        } else if (arg == "--check-scan") {
+            std::cout << "Board scan kernels:\n";
+            return BoardScan::selfTest(std::cout) ? 0 : 2;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (matches < 1 || threads < 1 || batch < 1 || workBatch < 1 ||
+        poolOptions.prefork < 0 || poolOptions.recycleAfter < 1 ||
+        poolOptions.callTimeoutMs < 1 ||
+        (!coordinatorAddr.empty() && (!workerAddr.empty() || watch))) {
+        usage(argv[0]);
+        return 1;
+    }
+    if ((!feedName.empty() || !replayPath.empty()) &&
+        (threads > 1 || batch > 1 || !coordinatorAddr.empty() || !workerAddr.empty())) {
+        std::cerr << "--spectate and --replay follow a single local arena; "
+                     "use --threads 1 --batch 1.\n";
+        return 1;
+    }
+    if (perf && (threads > 1 || batch > 1 || !coordinatorAddr.empty() ||
+                 !workerAddr.empty() || !sweepSpec.empty())) {
+        // the counters are opened for the main arena's thread only
+        std::cerr << "--perf counts the main arena's own matches; "
+                     "use --threads 1 --batch 1 without --sweep or distribution.\n";
+        return 1;
+    }
+    if (sweepSpec.empty() != sweepPath.empty() ||
+        (!sweepSpec.empty() && (watch || soakKb >= 0 || !mapsPath.empty() ||
+                                !feedName.empty() || !replayPath.empty() ||
+                                !coordinatorAddr.empty() || !workerAddr.empty()))) {
+        std::cerr << "--sweep needs --sweep-out and sets the board itself; it can't be "
+                     "combined with --watch, --soak, --maps, --spectate, --replay or "
+                     "distributed runs.\n";
+        return 1;
+    }
+    if (seeded && (threads > 1 || batch > 1) && workerAddr.empty()) {
+        // lanes interleave their robots' draws from the one std::rand()
+        std::cerr << "Warning: robots share std::rand() across --threads/--batch lanes, "
+                     "so per-seed results can differ from a sequential run. Use "
+                     "--threads 1 --batch 1 to pair runs by seed.\n";
+    }
+    if (pooled && watch) {
+        std::cerr << "--robot-pool workers keep the robot code they started with; "
+                     "it can't be combined with --watch.\n";
+        return 1;
+    }
+    if (pooled && heapCapKb > 0) {
+        // the robot's heap lives in its worker, out of the arena's sight
+        std::cerr << "--heap-cap can't see the heap of --robot-pool workers; "
+                     "use --recycle-growth to bound them.\n";
+        return 1;
+    }
+
+    if (!tracePath.empty()) {
+        Trace::enable();
+    }
+
+    // written however main exits, so a failed run still leaves a timeline
+    struct TraceWriter {
+        const std::string& path;
+        ~TraceWriter() {
+            if (!path.empty() && !Trace::writeChromeJson(path)) {
+                std::cerr << "Failed to write trace to " << path << "\n";
+            }
+        }
+    } traceWriter{tracePath};
+
+    // outlives the arena and its robots, which hold on to pool workers
+    std::vector<std::shared_ptr<RobotPool>> pools;
+
     try {
-        Arena arena(rows, cols);
+        std::shared_ptr<const MapPack> maps;
+        if (!mapsPath.empty()) {
+            maps = MapPack::open(mapsPath);
+            rows = maps->rows();
+            cols = maps->cols();
+        }
+
+        ArenaConfig config;
+        config.rows = rows;
+        config.cols = cols;
+        config.maps = maps;
+        config.heapCapKb = heapCapKb;
+        if (seeded) {
+            config.seed = seed;
+        }
+        Arena arena(config);
         arena.loadConfig("config.txt");   // TODO: create / adjust, or stub out
+        if (quiet || matches > 1 || threads > 1 || batch > 1 || soakKb >= 0 || watch ||
+            !coordinatorAddr.empty() || !workerAddr.empty() || !sweepSpec.empty()) {
+            arena.setWatchLive(false);
+        }
         arena.loadRobots();               // compile + dlopen + create robots
-        arena.run();                      // main game loop
+
+        if (pooled) {
+            // fork the pools while this is the only thread, then replay the
+            // first match's setup with pooled robots
+            for (const auto& robot : poolRoster(arena.roster(), poolOptions, pools)) {
+                arena.replaceRobot(robot);
+            }
+            arena.newMatch(arena.seed());
+        }
+
+        if (!feedName.empty()) {
+            arena.enableSpectatorFeed(feedName);
+        }
+        if (!replayPath.empty()) {
+            arena.enableReplay(replayPath);
+        }
+
+        if (perf && !arena.enablePerfCounters()) {
+            std::cerr << "Performance counters unavailable (perf_event_open failed); "
+                         "continuing without them.\n";
+        }
+
+        if (!sweepSpec.empty()) {
+            ArenaConfig base;
+            base.rows      = rows;
+            base.cols      = cols;
+            base.heapCapKb = heapCapKb;
+
+            BatchOptions options;
+            options.config     = base;
+            options.firstSeed  = arena.seed();
+            options.matches    = static_cast<uint64_t>(matches);
+            options.threads    = threads;
+            options.batchWidth = batch;
+
+            Sweep sweep(arena.roster(), expandSweep(parseSweep(sweepSpec), base),
+                        options, sweepPath);
+            size_t played = sweep.run(std::cout);
+            std::cout << "Played " << played << " sweep points into " << sweepPath << "\n";
+            return 0;
+        }
+
+        if (!workerAddr.empty()) {
+            BatchOptions options;
+            options.config.rows = rows;
+            options.config.cols = cols;
+            options.config.maps = maps;
+            options.config.heapCapKb = heapCapKb;
+            options.threads     = threads;
+            options.batchWidth  = batch;
+            return runWorker(workerAddr, arena.roster(), arena.configHash(), options) ? 0 : 1;
+        }
+
+        std::unique_ptr<ResultsWriter> results;
+        if (!resultsPath.empty()) {
+            results = std::make_unique<ResultsWriter>(resultsPath);
+        }
+
+        if (matches == 1 && !quiet && threads == 1 && batch == 1 && soakKb < 0 && !watch &&
+            coordinatorAddr.empty()) {
+            arena.run();                  // main game loop
+            if (results) {
+                results->append(arena.matchRecord());
+            }
+            arena.printPerfReport(std::cout);
+            return 0;
+        }
+
+        // Paired-match mode: one line per match keyed by seed, so the
+        // output of a run with robot A can be joined against robot A'.
+        uint32_t firstSeed = arena.seed();
+        std::map<std::string, int> wins;
+        int draws = 0;
+
+        // Soak mode: RSS must stay flat once the first 10% of the matches
+        // have warmed up the allocator and the robots' libraries.
+        int  played       = 0;
+        int  soakStep     = matches >= 10 ? matches / 10 : 1;
+        long warmRss      = 0;
+        long worstGrowth  = 0;
+
+        auto report = [&](const MatchRecord& rec) {
+            if (results) {
+                results->append(rec);
+            }
+            std::string who = "draw";
+            if (rec.winner >= 0) {
+                who = rec.robots[rec.winner].name;
+                ++wins[who];
+            } else {
+                ++draws;
+            }
+
+            ++played;
+            if (soakKb >= 0) {
+                if (played % soakStep == 0 || played == matches) {
+                    long rss = residentKb();
+                    if (warmRss == 0) {
+                        warmRss = rss;
+                    }
+                    worstGrowth = std::max(worstGrowth, rss - warmRss);
+                    std::cout << "soak " << played << " matches rss "
+                              << rss << " kB\n";
+                }
+                return;
+            }
+
+            std::cout << "match " << rec.seed - firstSeed
+                      << " seed " << rec.seed
+                      << " rounds " << rec.rounds
+                      << " winner " << who << "\n";
+        };
+
+        // Watch mode: replay the same seeds after every rebuild, so each
+        // summary is paired with the previous one.
+        std::unique_ptr<RobotWatcher> watcher;
+        if (watch) {
+            watcher = std::make_unique<RobotWatcher>(arena.roster());
+            if (watcher->watching() == 0) {
+                std::cerr << "No dynamically loaded robots to watch.\n";
+                watcher.reset();
+            }
+        }
+        uint64_t build  = 0;   // watcher generation the last pass played
+        uint64_t loaded = 0;   // generation of the robots in arena
+
+        for (int pass = 0; ; ++pass) {
+            if (!coordinatorAddr.empty()) {
+                std::vector<std::string> sources;
+                for (const auto& robot : arena.roster()) {
+                    sources.push_back(robot.source);
+                }
+                Coordinator coordinator(coordinatorAddr, arena.configHash(), sources,
+                                        firstSeed, static_cast<uint64_t>(matches),
+                                        static_cast<uint32_t>(workBatch));
+                coordinator.run(report);
+            } else if (threads > 1 || batch > 1) {
+                BatchOptions options;
+                options.config.rows = rows;
+                options.config.cols = cols;
+                options.config.maps = maps;
+                options.config.heapCapKb = heapCapKb;
+                options.firstSeed   = firstSeed;
+                options.matches     = static_cast<uint64_t>(matches);
+                options.threads     = threads;
+                options.batchWidth  = batch;
+                options.watcher     = watcher.get();
+
+                // the lanes load the latest build themselves
+                if (watcher) {
+                    build = watcher->generation();
+                }
+                BatchRunner runner(arena.roster(), options);
+                runner.run(report);
+            } else {
+                for (int m = 0; m < matches; ++m) {
+                    if (m > 0 || pass > 0) {
+                        if (watcher && watcher->generation() != loaded) {
+                            for (const auto& robot : watcher->roster(&loaded)) {
+                                arena.replaceRobot(robot);
+                            }
+                        }
+                        arena.newMatch(firstSeed + m);
+                    }
+                    arena.run();
+                    report(arena.matchRecord());
+                }
+                build = loaded;
+            }
+
+            std::cout << "\nSummary over " << matches << " matches:\n";
+            for (const auto& [who, count] : wins) {
+                std::cout << "  " << who << ": " << count << " wins\n";
+            }
+            std::cout << "  draws: " << draws << "\n";
+
+            if (!watcher) {
+                break;
+            }
+            std::cout << "\nWatching robot sources for changes (Ctrl-C to stop)...\n"
+                      << std::flush;
+            build = watcher->waitForChange(build);
+            std::cout << "\n";
+
+            wins.clear();
+            draws  = 0;
+            played = 0;
+        }
+
+        arena.printPerfReport(std::cout);
+
+        for (const auto& pool : pools) {
+            RobotPoolStats stats = pool->stats();
+            std::cout << "  pool " << pool->source() << ": " << stats.matches
+                      << " robots hosted, " << stats.started << " workers started, "
+                      << stats.recycled << " recycled, " << stats.crashed << " crashed\n";
+        }
+
+        if (soakKb >= 0) {
+            std::cout << "  rss growth after warmup: " << worstGrowth << " kB\n";
+            if (worstGrowth > soakKb) {
+                std::cout << "SOAK FAILED: limit " << soakKb << " kB\n";
+                return 2;
+            }
+        }
     }
     catch (const std::exception& ex) {
         std::cerr << "Fatal error: " << ex.what() << "\n";
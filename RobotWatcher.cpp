@@ -0,0 +1,117 @@
+#include "RobotWatcher.h"
+
+#include <iostream>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+RobotWatcher::RobotWatcher(std::vector<RegisteredRobot> roster,
+                           std::chrono::milliseconds poll)
+    : m_poll(poll),
+      m_roster(std::move(roster))
+{
+    for (size_t i = 0; i < m_roster.size(); ++i) {
+        if (!m_roster[i].library) continue;
+
+        Watched robot;
+        robot.slot   = i;
+        robot.source = m_roster[i].source + ".cpp";
+
+        std::error_code ec;
+        robot.mtime = fs::last_write_time(robot.source, ec);
+        if (ec) {
+            std::cerr << "Not watching " << robot.source << ": "
+                      << ec.message() << "\n";
+            continue;
+        }
+        m_watched.push_back(robot);
+    }
+
+    if (!m_watched.empty()) {
+        m_thread = std::thread(&RobotWatcher::watch, this);
+    }
+}
+
+RobotWatcher::~RobotWatcher()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_changed.notify_all();
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+uint64_t RobotWatcher::generation() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_generation;
+}
+
+std::vector<RegisteredRobot> RobotWatcher::roster(uint64_t* generation) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (generation) {
+        *generation = m_generation;
+    }
+    return m_roster;
+}
+
+uint64_t RobotWatcher::waitForChange(uint64_t seen) const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_changed.wait(lock, [&] { return m_generation != seen || m_stop; });
+    return m_generation;
+}
+
+void RobotWatcher::watch()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop) {
+        m_changed.wait_for(lock, m_poll, [this] { return m_stop; });
+        if (m_stop) break;
+
+        // compile without holding the lock; readers only need m_roster
+        lock.unlock();
+        for (auto& robot : m_watched) {
+            std::error_code ec;
+            auto mtime = fs::last_write_time(robot.source, ec);
+            if (ec || mtime == robot.mtime) continue;
+
+            robot.mtime = mtime;
+            rebuild(robot);
+        }
+        lock.lock();
+    }
+}
+
+void RobotWatcher::rebuild(Watched& robot)
+{
+    ++robot.version;
+    std::string base      = robot.source.stem().string();
+    std::string sharedLib = "lib" + base + ".v" + std::to_string(robot.version) + ".so";
+
+    std::cerr << "Rebuilding " << robot.source.string() << " to " << sharedLib << "...\n";
+    if (!RobotLibrary::compile(robot.source.string(), sharedLib)) {
+        return;   // keep playing the last good build
+    }
+
+    auto library = RobotLibrary::open("./" + sharedLib);
+    std::error_code ec;
+    fs::remove(sharedLib, ec);   // the mapping stays valid after unlink
+    if (!library) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_roster[robot.slot] = RegisteredRobot{base, library->factory(), library};
+        ++m_generation;
+    }
+    m_changed.notify_all();
+    std::cerr << "Reloaded " << base << " (v" << robot.version
+              << "), used from the next match\n";
+}
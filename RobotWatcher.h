@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RobotRegistry.h"
+
+// Watches the sources of a roster's dynamically loaded robots and rebuilds
+// a robot in the background whenever its Robot_*.cpp changes.
+//
+// Each rebuild goes to a new versioned file (libRobot_X.v2.so, ...) so the
+// dynamic loader can't hand back the old image, and that file is removed
+// again once it is open. The new build only shows up in roster(); callers
+// apply it with Arena::replaceRobot() at their next match boundary, so a
+// match in progress keeps the code it started with - and the library it
+// came from stays loaded until its last robot is gone.
+//
+// Robots linked into the executable (no library) are not watched.
+class RobotWatcher {
+public:
+    explicit RobotWatcher(std::vector<RegisteredRobot> roster,
+                          std::chrono::milliseconds poll = std::chrono::milliseconds(250));
+    ~RobotWatcher();
+
+    RobotWatcher(const RobotWatcher&) = delete;
+    RobotWatcher& operator=(const RobotWatcher&) = delete;
+
+    // Number of robots being watched.
+    size_t watching() const { return m_watched.size(); }
+
+    // Bumped after every successful rebuild.
+    uint64_t generation() const;
+
+    // The latest build of every robot, and the generation it belongs to.
+    std::vector<RegisteredRobot> roster(uint64_t* generation = nullptr) const;
+
+    // Block until generation() differs from seen; returns the new value.
+    uint64_t waitForChange(uint64_t seen) const;
+
+private:
+    struct Watched {
+        size_t                          slot;
+        std::filesystem::path           source;
+        std::filesystem::file_time_type mtime;
+        int                             version = 1;
+    };
+
+    void watch();
+    void rebuild(Watched& robot);
+
+    std::chrono::milliseconds m_poll;
+    std::vector<Watched>      m_watched;   // only touched by m_thread
+
+    mutable std::mutex              m_mutex;
+    mutable std::condition_variable m_changed;
+    std::vector<RegisteredRobot>    m_roster;
+    uint64_t                        m_generation = 0;
+    bool                            m_stop = false;
+
+    std::thread m_thread;
+};
@@ -0,0 +1,290 @@
+#include "SpectatorFeed.h"
+#include "FrameCodec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr size_t slotHeaderBytes = 16;   // u64 sequence, u32 bytes, u32 reserved
+
+uint64_t loadAcquire(const uint64_t* p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+void storeRelease(uint64_t* p, uint64_t value)
+{
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+size_t frameBytes(size_t robots, bool key, size_t cells)
+{
+    size_t bytes = sizeof(FeedFrame) + sizeof(FeedRobot) * robots;
+    if (key) {
+        bytes += feedNameBytes * robots + cells;
+    }
+    return bytes;
+}
+
+// Largest codec frame: a header of varints, then at worst a 17-byte event
+// (or 14-byte key entry) per robot.
+size_t codecBytes(size_t robots)
+{
+    return 64 + 17 * robots;
+}
+
+size_t headerBytes()
+{
+    return (sizeof(FeedHeader) + 63) & ~size_t(63);
+}
+}
+
+std::string FeedView::robotName(int slot) const
+{
+    if (!names) return std::string();
+    const char* p = names + slot * feedNameBytes;
+    return std::string(p, strnlen(p, feedNameBytes));
+}
+
+bool parseFeedFrame(const std::vector<unsigned char>& bytes,
+                    uint32_t rows, uint32_t cols, FeedView& view)
+{
+    if (bytes.size() < sizeof(FeedFrame)) return false;
+
+    view.frame = reinterpret_cast<const FeedFrame*>(bytes.data());
+    bool key = view.frame->kind == FeedFrame::Key;
+    size_t robots = view.frame->robots;
+    if (bytes.size() < frameBytes(robots, key, size_t(rows) * cols)) return false;
+
+    const unsigned char* p = bytes.data() + sizeof(FeedFrame);
+    view.robots = reinterpret_cast<const FeedRobot*>(p);
+    p += sizeof(FeedRobot) * robots;
+
+    view.names   = nullptr;
+    view.terrain = nullptr;
+    if (key) {
+        view.names   = reinterpret_cast<const char*>(p);
+        view.terrain = view.names + feedNameBytes * robots;
+    }
+    return true;
+}
+
+std::string SpectatorFeed::shmName(const std::string& name)
+{
+    return "/robotwarz-" + name;
+}
+
+SpectatorFeed::SpectatorFeed(const std::string& name, int rows, int cols,
+                             size_t maxRobots, uint32_t slots)
+    : m_shmName(shmName(name)), m_encoder(std::make_unique<FrameEncoder>())
+{
+    size_t slotBytes = slotHeaderBytes +
+                       std::max(frameBytes(maxRobots, true, size_t(rows) * cols),
+                                codecBytes(maxRobots));
+    slotBytes = (slotBytes + 63) & ~size_t(63);
+    m_bytes = headerBytes() + slotBytes * (size_t(slots) + 1);
+
+    // A feed left over under this name may still be mapped by its viewers
+    // (or its arena); truncating it in place would pull the pages out from
+    // under them. Unlink it instead - they keep the old object - and
+    // create a new one that starts from zeros.
+    shm_unlink(m_shmName.c_str());
+    int fd = shm_open(m_shmName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create spectator feed " + m_shmName);
+    }
+    struct stat st {};
+    if (ftruncate(fd, static_cast<off_t>(m_bytes)) != 0 || fstat(fd, &st) != 0) {
+        close(fd);
+        shm_unlink(m_shmName.c_str());
+        throw std::runtime_error("Cannot size spectator feed " + m_shmName);
+    }
+    m_inode = st.st_ino;
+
+    void* p = mmap(nullptr, m_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        shm_unlink(m_shmName.c_str());
+        throw std::runtime_error("Cannot map spectator feed " + m_shmName);
+    }
+
+    m_base   = static_cast<unsigned char*>(p);
+    m_header = reinterpret_cast<FeedHeader*>(m_base);
+    m_header->version   = feedVersion;
+    m_header->rows      = static_cast<uint32_t>(rows);
+    m_header->cols      = static_cast<uint32_t>(cols);
+    m_header->slotCount = slots;
+    m_header->slotBytes = static_cast<uint32_t>(slotBytes);
+    __atomic_store_n(&m_header->magic, feedMagic, __ATOMIC_RELEASE);
+}
+
+SpectatorFeed::~SpectatorFeed()
+{
+    __atomic_store_n(&m_header->closed, 1u, __ATOMIC_RELEASE);
+    munmap(m_base, m_bytes);
+
+    // viewers that are attached keep their mapping; leave the name alone
+    // if a newer feed has taken it over
+    int fd = shm_open(m_shmName.c_str(), O_RDONLY, 0);
+    if (fd >= 0) {
+        struct stat st {};
+        bool ours = fstat(fd, &st) == 0 && st.st_ino == m_inode;
+        close(fd);
+        if (ours) shm_unlink(m_shmName.c_str());
+    }
+}
+
+unsigned char* SpectatorFeed::slot(uint64_t index) const
+{
+    return m_base + headerBytes() + size_t(m_header->slotBytes) * index;
+}
+
+void SpectatorFeed::publish(const FeedFrame& frame, const FeedRobot* robots,
+                            const char* names, const char* terrain)
+{
+    if (frame.kind == FeedFrame::Key) {
+        size_t cells = size_t(m_header->rows) * m_header->cols;
+        m_frameBytes.resize(frameBytes(frame.robots, true, cells));
+        unsigned char* p = m_frameBytes.data();
+        std::memcpy(p, &frame, sizeof(frame));
+        p += sizeof(frame);
+        std::memcpy(p, robots, sizeof(FeedRobot) * frame.robots);
+        p += sizeof(FeedRobot) * frame.robots;
+        std::memcpy(p, names, feedNameBytes * frame.robots);
+        p += feedNameBytes * frame.robots;
+        std::memcpy(p, terrain, cells);
+        write(slot(0), m_keys++, m_frameBytes);
+    }
+
+    m_encoder->encode(frame, robots, m_frameBytes);
+    uint64_t n = m_published++;
+    write(slot(1 + n % m_header->slotCount), n, m_frameBytes);
+    storeRelease(&m_header->published, m_published);
+}
+
+void SpectatorFeed::write(unsigned char* slot, uint64_t sequence,
+                          const std::vector<unsigned char>& bytes)
+{
+    auto* seq  = reinterpret_cast<uint64_t*>(slot);
+    auto  size = static_cast<uint32_t>(bytes.size());
+
+    // odd: a reader that sees this (or sees it change) drops the copy
+    __atomic_store_n(seq, 2 * sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    std::memcpy(slot + sizeof(uint64_t), &size, sizeof(size));
+    std::memcpy(slot + slotHeaderBytes, bytes.data(), bytes.size());
+
+    storeRelease(seq, 2 * sequence + 2);
+}
+
+SpectatorView::SpectatorView(const std::string& name)
+{
+    std::string shm = SpectatorFeed::shmName(name);
+    int fd = shm_open(shm.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw std::runtime_error("No spectator feed " + shm + " (is RobotWarz --spectate running?)");
+    }
+
+    struct stat st {};
+    fstat(fd, &st);
+    m_bytes = static_cast<size_t>(st.st_size);
+    if (m_bytes < headerBytes()) {
+        close(fd);
+        throw std::runtime_error("Spectator feed " + shm + " is not ready");
+    }
+
+    void* p = mmap(nullptr, m_bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        throw std::runtime_error("Cannot map spectator feed " + shm);
+    }
+    m_base   = static_cast<const unsigned char*>(p);
+    m_header = reinterpret_cast<const FeedHeader*>(m_base);
+
+    if (__atomic_load_n(&m_header->magic, __ATOMIC_ACQUIRE) != feedMagic ||
+        m_header->version != feedVersion) {
+        munmap(const_cast<unsigned char*>(m_base), m_bytes);
+        throw std::runtime_error("Spectator feed " + shm + " is not ready or has the wrong version");
+    }
+
+    m_rows      = m_header->rows;
+    m_cols      = m_header->cols;
+    m_slotCount = m_header->slotCount;
+    m_slotBytes = m_header->slotBytes;
+    if (m_bytes < headerBytes() + size_t(m_slotBytes) * (m_slotCount + 1)) {
+        munmap(const_cast<unsigned char*>(m_base), m_bytes);
+        throw std::runtime_error("Spectator feed " + shm + " is truncated");
+    }
+
+    // start with the live frame, not the history
+    uint64_t published = loadAcquire(&m_header->published);
+    m_next = published > 0 ? published - 1 : 0;
+}
+
+SpectatorView::~SpectatorView()
+{
+    munmap(const_cast<unsigned char*>(m_base), m_bytes);
+}
+
+bool SpectatorView::writerClosed() const
+{
+    return __atomic_load_n(&m_header->closed, __ATOMIC_ACQUIRE) != 0;
+}
+
+bool SpectatorView::readSlot(const unsigned char* slot, uint64_t sequence,
+                             std::vector<unsigned char>& bytes) const
+{
+    const auto* seq = reinterpret_cast<const uint64_t*>(slot);
+    uint64_t want = 2 * sequence + 2;
+
+    if (loadAcquire(seq) != want) return false;
+
+    uint32_t size;
+    std::memcpy(&size, slot + sizeof(uint64_t), sizeof(size));
+    if (size > m_slotBytes - slotHeaderBytes) return false;
+    bytes.assign(slot + slotHeaderBytes, slot + slotHeaderBytes + size);
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(seq, __ATOMIC_RELAXED) == want;
+}
+
+bool SpectatorView::next(std::vector<unsigned char>& bytes)
+{
+    for (;;) {
+        uint64_t published = loadAcquire(&m_header->published);
+        if (m_next >= published) return false;
+
+        // too far behind: jump to the newest frame rather than replaying
+        // a backlog the writer is about to overwrite anyway
+        if (published - m_next > m_slotCount / 2) {
+            m_dropped += published - 1 - m_next;
+            m_next = published - 1;
+        }
+
+        uint64_t n = m_next++;
+        const unsigned char* slot =
+            m_base + headerBytes() + size_t(m_slotBytes) * (1 + n % m_slotCount);
+        if (readSlot(slot, n, bytes)) return true;
+        ++m_dropped;   // overwritten while we were copying it
+    }
+}
+
+bool SpectatorView::key(std::vector<unsigned char>& bytes) const
+{
+    const unsigned char* slot = m_base + headerBytes();
+    const auto* seq = reinterpret_cast<const uint64_t*>(slot);
+
+    for (int tries = 0; tries < 100; ++tries) {
+        uint64_t s = loadAcquire(seq);
+        if (s == 0) return false;          // no key frame yet
+        if (s % 2 == 1) continue;          // being written
+        if (readSlot(slot, s / 2 - 1, bytes)) return true;
+    }
+    return false;
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Live match frames in shared memory, for any number of local viewers.
+//
+// The arena (writer) publishes a frame after every robot turn into a ring
+// of fixed-size slots in a POSIX shared memory object. Each slot is a
+// seqlock: its sequence number is odd while the writer is copying into
+// it, and equals 2 * frame + 2 once frame is complete. Viewers map the
+// object read-only, copy a slot and then re-check its sequence number, so
+// they never take a lock or write anything the writer waits on. A viewer
+// that falls behind by more than the ring simply loses frames.
+//
+// Ring frames are encoded by the frame codec (FrameCodec.h): mostly
+// deltas of the robots that changed, with a key frame of the whole table
+// every so often. A viewer that lost frames waits for the next key frame.
+//
+// Terrain and names don't change during a match, so they are only sent in
+// the raw key frame written at the start of each match. It lives in its
+// own seqlocked slot so a viewer that attaches mid-match can still fetch
+// it.
+//
+// Shared memory layout
+// --------------------
+//   FeedHeader                              (64 bytes)
+//   key slot                                (slotBytes)
+//   slotCount ring slots                    (slotBytes each)
+//
+//   slot:  u64 sequence, u32 bytes, u32 reserved, then the frame
+//   key:   FeedFrame, FeedRobot[robots], char[robots][feedNameBytes]
+//          names and char[rows * cols] terrain, row-major
+//   ring:  one codec frame
+
+constexpr uint32_t feedMagic     = 0x46535752;   // "RWSF"
+constexpr uint32_t feedVersion   = 2;
+constexpr size_t   feedNameBytes = 32;
+
+struct FeedHeader {
+    uint32_t magic;        // written last by the writer
+    uint32_t version;
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t slotCount;
+    uint32_t slotBytes;
+    uint64_t published;    // frames written so far
+    uint32_t closed;       // set when the writer goes away
+    uint32_t reserved[7];
+};
+
+struct FeedFrame {
+    enum Kind : uint16_t { Key, Turn };
+
+    uint64_t match;        // counts matches since the feed was opened
+    uint32_t seed;
+    uint32_t round;
+    int32_t  turn;         // slot of the robot that just acted, or -1
+    uint16_t kind;
+    uint16_t robots;
+};
+
+struct FeedRobot {
+    enum Flags : uint8_t { Alive = 1, InPit = 2 };
+
+    char     symbol;
+    uint8_t  flags;
+    uint16_t row;
+    uint16_t col;
+    int16_t  health;
+    int16_t  armor;
+    uint16_t reserved;
+};
+
+// A frame copied out of the feed, with pointers into its parts.
+struct FeedView {
+    const FeedFrame* frame   = nullptr;
+    const FeedRobot* robots  = nullptr;
+    const char*      names   = nullptr;   // key frames only
+    const char*      terrain = nullptr;   // key frames only
+
+    std::string robotName(int slot) const;
+};
+
+// Split the raw bytes of a key slot frame; false if they are too short.
+bool parseFeedFrame(const std::vector<unsigned char>& bytes,
+                    uint32_t rows, uint32_t cols, FeedView& view);
+
+class FrameEncoder;
+
+// Writer side, owned by the arena.
+class SpectatorFeed {
+public:
+    // Creates shared memory object "/robotwarz-<name>". An older feed of
+    // that name is unlinked, not reused: viewers still attached to it keep
+    // their mapping and see no new frames.
+    SpectatorFeed(const std::string& name, int rows, int cols,
+                  size_t maxRobots, uint32_t slots = 256);
+    ~SpectatorFeed();
+
+    SpectatorFeed(const SpectatorFeed&) = delete;
+    SpectatorFeed& operator=(const SpectatorFeed&) = delete;
+
+    static std::string shmName(const std::string& name);
+
+    // frame.robots entries follow in robots; key frames also pass names
+    // (frame.robots * feedNameBytes) and rows * cols terrain bytes.
+    void publish(const FeedFrame& frame, const FeedRobot* robots,
+                 const char* names = nullptr, const char* terrain = nullptr);
+
+private:
+    unsigned char* slot(uint64_t index) const;
+    void           write(unsigned char* slot, uint64_t sequence,
+                         const std::vector<unsigned char>& bytes);
+
+    std::string    m_shmName;
+    unsigned char* m_base  = nullptr;
+    size_t         m_bytes = 0;
+    FeedHeader*    m_header = nullptr;
+    uint64_t       m_published = 0;
+    uint64_t       m_keys      = 0;
+    uint64_t       m_inode     = 0;   // to unlink only our own object
+    std::unique_ptr<FrameEncoder> m_encoder;
+    std::vector<unsigned char>    m_frameBytes;
+};
+
+// Reader side, for viewer processes.
+class SpectatorView {
+public:
+    explicit SpectatorView(const std::string& name);
+    ~SpectatorView();
+
+    SpectatorView(const SpectatorView&) = delete;
+    SpectatorView& operator=(const SpectatorView&) = delete;
+
+    uint32_t rows() const { return m_rows; }
+    uint32_t cols() const { return m_cols; }
+
+    // Copy the next ring frame (codec-encoded) into bytes. Returns false if there
+    // is nothing new. Frames the writer has already overwritten are
+    // skipped and counted in dropped().
+    bool next(std::vector<unsigned char>& bytes);
+
+    // Copy the current raw key frame; false if none is published yet or the
+    // writer kept rewriting it.
+    bool key(std::vector<unsigned char>& bytes) const;
+
+    bool     writerClosed() const;
+    uint64_t dropped() const { return m_dropped; }
+
+private:
+    bool readSlot(const unsigned char* slot, uint64_t sequence,
+                  std::vector<unsigned char>& bytes) const;
+
+    const unsigned char* m_base  = nullptr;
+    size_t               m_bytes = 0;
+    const FeedHeader*    m_header = nullptr;
+    uint32_t             m_rows = 0;
+    uint32_t             m_cols = 0;
+    uint32_t             m_slotCount = 0;
+    uint32_t             m_slotBytes = 0;
+    uint64_t             m_next    = 0;
+    uint64_t             m_dropped = 0;
+};
@@ -0,0 +1,266 @@
+#include "Sweep.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+const char* const weaponColumns[] = {"winFlamethrower", "winRailgun", "winGrenade", "winHammer"};
+constexpr int numWeapons = 4;
+
+bool parseInt(const std::string& text, int& value)
+{
+    try {
+        size_t used = 0;
+        value = std::stoi(text, &used);
+        return used == text.size();
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+}
+
+std::string describe(const ArenaConfig& config)
+{
+    std::ostringstream out;
+    out << config.rows << "x" << config.cols << " mounds " << config.numMounds
+        << " pits " << config.numPits << " flamers " << config.numFlamers
+        << " maxRounds " << config.maxRounds;
+    return out.str();
+}
+}
+
+std::vector<SweepAxis> parseSweep(const std::string& spec)
+{
+    static const char* const names[] = {"rows", "cols", "size", "mounds", "pits",
+                                        "flamers", "maxRounds"};
+
+    std::vector<SweepAxis> axes;
+    std::stringstream in(spec);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        size_t equals = item.find('=');
+        if (equals == std::string::npos) {
+            throw std::runtime_error("Sweep axis '" + item + "' is not name=first[:last[:step]]");
+        }
+
+        SweepAxis axis;
+        axis.name = item.substr(0, equals);
+        bool known = false;
+        for (const char* name : names) {
+            known = known || axis.name == name;
+        }
+        if (!known) {
+            throw std::runtime_error("Unknown sweep parameter '" + axis.name + "'");
+        }
+
+        std::vector<std::string> parts;
+        std::stringstream range(item.substr(equals + 1));
+        std::string part;
+        while (std::getline(range, part, ':')) {
+            parts.push_back(part);
+        }
+
+        bool ok = !parts.empty() && parts.size() <= 3 && parseInt(parts[0], axis.first);
+        axis.last = axis.first;
+        if (ok && parts.size() > 1) ok = parseInt(parts[1], axis.last);
+        if (ok && parts.size() > 2) ok = parseInt(parts[2], axis.step);
+        if (!ok || axis.first < 0 || axis.last < axis.first || axis.step < 1) {
+            throw std::runtime_error("Bad sweep range '" + item + "'");
+        }
+        axes.push_back(axis);
+    }
+
+    if (axes.empty()) {
+        throw std::runtime_error("Empty sweep");
+    }
+    return axes;
+}
+
+std::vector<ArenaConfig> expandSweep(const std::vector<SweepAxis>& axes,
+                                     const ArenaConfig& base)
+{
+    std::vector<ArenaConfig> grid = {base};
+    for (const auto& axis : axes) {
+        std::vector<ArenaConfig> next;
+        for (const auto& config : grid) {
+            for (int value = axis.first; value <= axis.last; value += axis.step) {
+                ArenaConfig point = config;
+                if (axis.name == "rows" || axis.name == "size") point.rows = value;
+                if (axis.name == "cols" || axis.name == "size") point.cols = value;
+                if (axis.name == "mounds")    point.numMounds  = value;
+                if (axis.name == "pits")      point.numPits    = value;
+                if (axis.name == "flamers")   point.numFlamers = value;
+                if (axis.name == "maxRounds") point.maxRounds  = value;
+                next.push_back(point);
+            }
+        }
+        grid = std::move(next);
+    }
+    return grid;
+}
+
+Sweep::Sweep(std::vector<RegisteredRobot> roster, std::vector<ArenaConfig> grid,
+             const BatchOptions& options, const std::string& path)
+    : m_roster(std::move(roster)),
+      m_grid(std::move(grid)),
+      m_options(options),
+      m_path(path)
+{
+    for (const auto& config : m_grid) {
+        // obstacles are scattered at random until they fit, so leave room
+        long cells     = long(config.rows) * config.cols;
+        long occupied  = long(config.numMounds) + config.numPits + config.numFlamers +
+                         static_cast<long>(m_roster.size());
+        if (config.rows < 10 || config.cols < 10 || config.maxRounds < 1 ||
+            occupied > cells / 2) {
+            throw std::runtime_error("Sweep point " + describe(config) +
+                                     " is not playable (boards are at least 10x10, "
+                                     "with at most half the cells taken)");
+        }
+    }
+
+    // the weapon each slot fights with, to credit its wins
+    for (const auto& robot : m_roster) {
+        std::unique_ptr<RobotBase> probe(robot.factory());
+        m_weapons.push_back(probe ? static_cast<int>(probe->get_weapon()) : -1);
+    }
+
+    resume();
+}
+
+Sweep::Key Sweep::keyOf(const ArenaConfig& config)
+{
+    return {config.rows, config.cols, config.numMounds, config.numPits,
+            config.numFlamers, config.maxRounds};
+}
+
+std::string Sweep::header() const
+{
+    std::ostringstream out;
+    out << "# sweep firstSeed " << m_options.firstSeed << " matches " << m_options.matches
+        << " heapCapKb " << m_options.config.heapCapKb << " robots";
+    for (const auto& robot : m_roster) {
+        out << " " << robot.source;
+    }
+    return out.str();
+}
+
+void Sweep::resume()
+{
+    std::ifstream in(m_path, std::ios::binary);
+    if (!in) {
+        std::ofstream out(m_path);
+        out << header() << "\n"
+            << "rows\tcols\tmounds\tpits\tflamers\tmaxRounds\tmatches\tdrawRate\tavgRounds";
+        for (const char* column : weaponColumns) {
+            out << "\t" << column;
+        }
+        out << "\n";
+        if (!out) {
+            throw std::runtime_error("Cannot create sweep results " + m_path);
+        }
+        return;
+    }
+
+    std::string line;
+    if (!std::getline(in, line) || line != header()) {
+        throw std::runtime_error(m_path + " holds another sweep (" + line +
+                                 "); use a new results file");
+    }
+    std::getline(in, line);   // column names
+
+    // only lines that made it out whole count
+    std::streamoff good = in.tellg();
+    while (std::getline(in, line) && !in.eof()) {
+        std::istringstream fields(line);
+        Key key(6);
+        for (int& value : key) {
+            fields >> value;
+        }
+        if (!fields) break;
+        m_done.insert(key);
+        good = in.tellg();
+    }
+
+    in.close();
+    if (good >= 0 && static_cast<uintmax_t>(good) < fs::file_size(m_path)) {
+        fs::resize_file(m_path, static_cast<uintmax_t>(good));
+    }
+}
+
+size_t Sweep::run(std::ostream& log)
+{
+    std::ofstream out(m_path, std::ios::app);
+    if (!out) {
+        throw std::runtime_error("Cannot append to sweep results " + m_path);
+    }
+
+    size_t played = 0;
+    for (size_t p = 0; p < m_grid.size(); ++p) {
+        const ArenaConfig& config = m_grid[p];
+        log << "point " << p + 1 << "/" << m_grid.size() << " " << describe(config);
+        if (m_done.count(keyOf(config))) {
+            log << ": already done\n";
+            continue;
+        }
+        log << std::flush;
+
+        uint64_t matches = 0;
+        uint64_t draws   = 0;
+        uint64_t rounds  = 0;
+        uint64_t wins[numWeapons] = {};
+
+        BatchOptions options = m_options;
+        options.config           = config;
+        options.config.heapCapKb = m_options.config.heapCapKb;
+        options.config.seed.reset();
+        BatchRunner runner(m_roster, options);
+        runner.run([&](const MatchRecord& rec) {
+            ++matches;
+            rounds += rec.rounds;
+            if (rec.winner < 0) {
+                ++draws;
+            } else if (m_weapons[rec.winner] >= 0) {
+                ++wins[m_weapons[rec.winner]];
+            }
+        });
+
+        double n = matches ? static_cast<double>(matches) : 1.0;
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(4);
+        for (int value : keyOf(config)) {
+            line << value << "\t";
+        }
+        line << matches << "\t" << draws / n << "\t" << std::setprecision(2) << rounds / n
+             << std::setprecision(4);
+        for (int w = 0; w < numWeapons; ++w) {
+            bool fielded = false;
+            for (int weapon : m_weapons) {
+                fielded = fielded || weapon == w;
+            }
+            line << "\t";
+            if (fielded) {
+                line << wins[w] / n;
+            } else {
+                line << "-";
+            }
+        }
+
+        out << line.str() << "\n" << std::flush;
+        if (!out) {
+            throw std::runtime_error("Cannot write sweep results " + m_path);
+        }
+        m_done.insert(keyOf(config));
+        ++played;
+        log << ": draws " << draws << "/" << matches << "\n";
+    }
+    return played;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Arena.h"
+#include "BatchRunner.h"
+#include "RobotRegistry.h"
+
+// Parameter sweeps
+// ----------------
+// A sweep plays the same seeds on every point of a grid of arena rules and
+// writes one line of aggregates per point, so rule changes can be compared
+// without a rebuild per point. The grid is given as axes,
+//
+//   rows=20:40:10,mounds=0:10:5,maxRounds=200
+//
+// each name=first[:last[:step]] (step 1 by default). Names are rows, cols,
+// size (rows and cols together), mounds, pits, flamers and maxRounds;
+// parameters without an axis keep the base config's value. Points are
+// played in order with the last axis varying fastest.
+//
+// The results file is tab-separated text: a "# sweep" line naming the
+// seeds and roster, a column header, then per point
+//
+//   rows cols mounds pits flamers maxRounds matches drawRate avgRounds
+//   winFlamethrower winRailgun winGrenade winHammer
+//
+// A win rate is the share of matches won by a robot with that weapon, "-"
+// if no robot in the roster carries it. Each line is flushed as its point
+// finishes, and the file doubles as the checkpoint: run the same sweep on
+// it again and the points already there are skipped (a line cut short by
+// an interrupted run is dropped and its point replayed).
+
+struct SweepAxis {
+    std::string name;
+    int         first = 0;
+    int         last  = 0;
+    int         step  = 1;
+};
+
+// Throws std::runtime_error on an unknown name or a malformed range.
+std::vector<SweepAxis> parseSweep(const std::string& spec);
+
+// Every combination of the axes' values, on top of base.
+std::vector<ArenaConfig> expandSweep(const std::vector<SweepAxis>& axes,
+                                     const ArenaConfig& base);
+
+class Sweep {
+public:
+    // Plays options.matches matches from options.firstSeed on each point
+    // of grid, with options.threads and options.batchWidth (options.config
+    // is replaced by each point). Opens or creates path; throws if it
+    // holds a different sweep or a point leaves too little free board.
+    Sweep(std::vector<RegisteredRobot> roster, std::vector<ArenaConfig> grid,
+          const BatchOptions& options, const std::string& path);
+
+    // Play every point not yet in the file, appending its line. Progress
+    // goes to log. Returns the number of points played.
+    size_t run(std::ostream& log);
+
+private:
+    using Key = std::vector<int>;   // rows, cols, mounds, pits, flamers, maxRounds
+
+    static Key keyOf(const ArenaConfig& config);
+    std::string header() const;
+    void        resume();   // read the checkpoint, drop a partial line
+
+    std::vector<RegisteredRobot> m_roster;
+    std::vector<ArenaConfig>     m_grid;
+    BatchOptions                 m_options;
+    std::string                  m_path;
+    std::vector<int>             m_weapons;   // per roster slot, -1 if unknown
+    std::set<Key>                m_done;
+};
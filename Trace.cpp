@@ -0,0 +1,135 @@
+#include "Trace.h"
+
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+struct TraceEvent {
+    const char*    name;
+    int32_t        arg;
+    Trace::ArgKind kind;
+    char           phase;   // 'B'/'E', or 'b'/'e' for async events
+    uint64_t       nanos;
+    uint64_t       id;      // async events only
+};
+
+struct ThreadBuffer {
+    uint32_t                tid = 0;
+    std::vector<TraceEvent> events;
+};
+
+// Buffers outlive their threads so they can be exported at exit.
+std::mutex                                  g_registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>>  g_buffers;
+std::map<int32_t, std::string>              g_labels;
+
+std::chrono::steady_clock::time_point g_epoch;
+
+thread_local ThreadBuffer* t_buffer = nullptr;
+
+ThreadBuffer& threadBuffer()
+{
+    if (!t_buffer) {
+        // once per thread
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        auto buffer = std::make_unique<ThreadBuffer>();
+        buffer->tid = static_cast<uint32_t>(g_buffers.size() + 1);
+        buffer->events.reserve(1 << 16);
+        t_buffer = buffer.get();
+        g_buffers.push_back(std::move(buffer));
+    }
+    return *t_buffer;
+}
+
+void record(const char* name, int32_t arg, Trace::ArgKind kind, char phase, uint64_t id = 0)
+{
+    uint64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - g_epoch).count();
+    threadBuffer().events.push_back(TraceEvent{name, arg, kind, phase, nanos, id});
+}
+
+void writeEscaped(std::ostream& out, const std::string& text)
+{
+    for (char ch : text) {
+        if (ch == '"' || ch == '\\') out << '\\';
+        if (static_cast<unsigned char>(ch) >= 0x20) out << ch;
+    }
+}
+}
+
+void Trace::enable()
+{
+    g_epoch = std::chrono::steady_clock::now();
+    s_enabled = true;
+}
+
+void Trace::begin(const char* name, int32_t arg, ArgKind kind)
+{
+    record(name, arg, kind, 'B');
+}
+
+void Trace::end(const char* name)
+{
+    record(name, -1, NoArg, 'E');
+}
+
+void Trace::beginAsync(const char* name, uint64_t id, int32_t arg, ArgKind kind)
+{
+    record(name, arg, kind, 'b', id);
+}
+
+void Trace::endAsync(const char* name, uint64_t id)
+{
+    record(name, -1, NoArg, 'e', id);
+}
+
+void Trace::labelRobot(int32_t slot, const std::string& label)
+{
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    g_labels[slot] = label;
+}
+
+bool Trace::writeChromeJson(const std::string& path)
+{
+    std::ofstream out(path);
+    if (!out) return false;
+
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& buffer : g_buffers) {
+        for (const auto& ev : buffer->events) {
+            if (!first) out << ",\n";
+            first = false;
+
+            out << "{\"name\":\"" << ev.name << "\",\"ph\":\"" << ev.phase
+                << "\",\"pid\":1,\"tid\":" << buffer->tid
+                << ",\"ts\":" << ev.nanos / 1000 << "." << (ev.nanos % 1000) / 100
+                << (ev.nanos % 100) / 10 << ev.nanos % 10;
+            if (ev.phase == 'b' || ev.phase == 'e') {
+                out << ",\"cat\":\"arena\",\"id\":\"0x" << std::hex << ev.id << std::dec << "\"";
+            }
+
+            if (ev.kind == ValueArg) {
+                out << ",\"args\":{\"value\":" << ev.arg << "}";
+            } else if (ev.kind == RobotArg) {
+                out << ",\"args\":{\"slot\":" << ev.arg;
+                auto label = g_labels.find(ev.arg);
+                if (label != g_labels.end()) {
+                    out << ",\"robot\":\"";
+                    writeEscaped(out, label->second);
+                    out << "\"";
+                }
+                out << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Begin/end timeline events, exported as Chrome trace JSON (open the file
+// in Perfetto or chrome://tracing).
+//
+// Each thread appends to its own buffer, so recording takes no locks.
+// While tracing is disabled a TRACE_SCOPE costs one well-predicted branch
+// on Trace::enabled(). Build with -DROBOTWARZ_NO_TRACE to compile the
+// scopes out entirely.
+class Trace {
+public:
+    // What an event's integer argument means in the exported file.
+    enum ArgKind : uint8_t { NoArg, ValueArg, RobotArg };
+
+    // Start recording. Call before any worker threads start.
+    static void enable();
+    static bool enabled() { return s_enabled; }
+
+    // name must be a string literal (only the pointer is stored). arg is
+    // shown in the event's args: a plain value, or a robot slot that is
+    // exported with the robot's label.
+    static void begin(const char* name, int32_t arg, ArgKind kind);
+    static void end(const char* name);
+
+    // Async begin/end ("b"/"e"), matched by name and id instead of by
+    // nesting on the thread. For spans that stay open across a co_await:
+    // under a TurnScheduler other arenas record events on the same thread
+    // meanwhile, which would break plain begin/end nesting.
+    static void beginAsync(const char* name, uint64_t id, int32_t arg, ArgKind kind);
+    static void endAsync(const char* name, uint64_t id);
+
+    // Readable name for a robot slot ("Sentinel #"). Not for hot paths -
+    // takes a lock.
+    static void labelRobot(int32_t slot, const std::string& label);
+
+    // Write everything recorded so far. Only call once the threads that
+    // recorded events have stopped.
+    static bool writeChromeJson(const std::string& path);
+
+private:
+    static inline bool s_enabled = false;
+};
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* name, int32_t arg = -1,
+                        Trace::ArgKind kind = Trace::NoArg)
+        : m_name(Trace::enabled() ? name : nullptr)
+    {
+        if (m_name) Trace::begin(m_name, arg, kind);
+    }
+
+    ~TraceScope()
+    {
+        if (m_name) Trace::end(m_name);
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_name;
+};
+
+// A TraceScope whose events are async, keyed by id (see beginAsync()).
+class TraceAsyncScope {
+public:
+    TraceAsyncScope(const char* name, uint64_t id, int32_t arg = -1,
+                    Trace::ArgKind kind = Trace::NoArg)
+        : m_name(Trace::enabled() ? name : nullptr), m_id(id)
+    {
+        if (m_name) Trace::beginAsync(m_name, m_id, arg, kind);
+    }
+
+    ~TraceAsyncScope()
+    {
+        if (m_name) Trace::endAsync(m_name, m_id);
+    }
+
+    TraceAsyncScope(const TraceAsyncScope&) = delete;
+    TraceAsyncScope& operator=(const TraceAsyncScope&) = delete;
+
+private:
+    const char* m_name;
+    uint64_t    m_id;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// TRACE_SCOPE("name"), TRACE_VALUE_SCOPE("name", value) and
+// TRACE_ROBOT_SCOPE("name", slot) trace the enclosing block, which must
+// not suspend; TRACE_ASYNC_VALUE_SCOPE("name", id, value) traces one that
+// may.
+#ifdef ROBOTWARZ_NO_TRACE
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_VALUE_SCOPE(name, value) ((void)(value))
+#define TRACE_ROBOT_SCOPE(name, slot) ((void)(slot))
+#define TRACE_ASYNC_VALUE_SCOPE(name, id, value) ((void)(id), (void)(value))
+#else
+#define TRACE_ASYNC_VALUE_SCOPE(name, id, value) \
+    TraceAsyncScope TRACE_CONCAT(traceScope_, __LINE__)(name, id, value, Trace::ValueArg)
+#define TRACE_SCOPE(name) \
+    TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define TRACE_VALUE_SCOPE(name, value) \
+    TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name, value, Trace::ValueArg)
+#define TRACE_ROBOT_SCOPE(name, slot) \
+    TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name, slot, Trace::RobotArg)
+#endif
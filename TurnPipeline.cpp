@@ -0,0 +1,159 @@
+#include "TurnPipeline.h"
+
+#include <new>
+#include <utility>
+#include <poll.h>
+
+namespace {
+// Frames freed on this thread, kept for reuse by the next Task of the same
+// size - a round only ever has a few alive, so the list stays short.
+struct FramePool {
+    static constexpr size_t keep = 256;
+
+    std::vector<std::pair<std::size_t, void*>> frames;
+
+    ~FramePool()
+    {
+        for (const auto& frame : frames) {
+            ::operator delete(frame.second);
+        }
+    }
+};
+
+thread_local FramePool      t_framePool;
+thread_local TurnScheduler* t_current = nullptr;
+}
+
+void* Task::promise_type::operator new(std::size_t size)
+{
+    auto& frames = t_framePool.frames;
+    for (size_t i = frames.size(); i-- > 0;) {
+        if (frames[i].first == size) {
+            void* frame = frames[i].second;
+            frames[i] = frames.back();
+            frames.pop_back();
+            return frame;
+        }
+    }
+    return ::operator new(size);
+}
+
+void Task::promise_type::operator delete(void* frame, std::size_t size)
+{
+    auto& frames = t_framePool.frames;
+    if (frames.size() < FramePool::keep) {
+        frames.emplace_back(size, frame);
+    } else {
+        ::operator delete(frame);
+    }
+}
+
+Task& Task::operator=(Task&& other) noexcept
+{
+    if (this != &other) {
+        if (m_handle) m_handle.destroy();
+        m_handle = std::exchange(other.m_handle, {});
+    }
+    return *this;
+}
+
+Task::~Task()
+{
+    if (m_handle) m_handle.destroy();
+}
+
+void Task::wait()
+{
+    if (done()) return;
+
+    // robots are waited for in place, not parked with a scheduler
+    TurnScheduler* scheduler = std::exchange(t_current, nullptr);
+    m_handle.resume();
+    t_current = scheduler;
+
+    if (m_handle.promise().error) {
+        std::rethrow_exception(m_handle.promise().error);
+    }
+}
+
+TurnScheduler* TurnScheduler::current()
+{
+    return t_current;
+}
+
+void TurnScheduler::spawn(Task task)
+{
+    m_ready.push_back(task.m_handle);
+    m_tasks.push_back(std::move(task));
+}
+
+void TurnScheduler::park(std::coroutine_handle<> handle, AsyncRobot* robot)
+{
+    m_parked.push_back(Parked{handle, robot});
+}
+
+// Move parked tasks whose robot has answered to the ready list.
+bool TurnScheduler::wake()
+{
+    bool woke = false;
+    for (size_t i = 0; i < m_parked.size();) {
+        if (m_parked[i].robot->finished()) {
+            m_ready.push_back(m_parked[i].handle);
+            m_parked[i] = m_parked.back();
+            m_parked.pop_back();
+            woke = true;
+        } else {
+            ++i;
+        }
+    }
+    return woke;
+}
+
+void TurnScheduler::run()
+{
+    TurnScheduler* outer = std::exchange(t_current, this);
+
+    std::vector<std::coroutine_handle<>> batch;
+    std::vector<pollfd>                  fds;
+
+    while (!m_ready.empty() || !m_parked.empty()) {
+        // resume in the order tasks became ready, so with no async robots
+        // the tasks simply run one after another
+        batch.swap(m_ready);
+        for (auto handle : batch) {
+            handle.resume();
+        }
+        batch.clear();
+
+        if (!m_ready.empty() || m_parked.empty() || wake()) continue;
+
+        // everyone is waiting: sleep on the robots' descriptors, or poll
+        // briefly if some robot doesn't offer one, and wake up by the
+        // first deadline
+        fds.clear();
+        int timeout = -1;
+        for (const auto& parked : m_parked) {
+            int fd = parked.robot->ready_fd();
+            if (fd < 0) {
+                timeout = 1;
+            } else {
+                fds.push_back(pollfd{fd, POLLIN, 0});
+            }
+            int due = parked.robot->timeout_ms();
+            if (due >= 0 && (timeout < 0 || due < timeout)) timeout = due;
+        }
+        poll(fds.data(), fds.size(), timeout);
+        wake();
+    }
+
+    t_current = outer;
+
+    std::exception_ptr error;
+    for (const auto& task : m_tasks) {
+        if (!error && task.m_handle.promise().error) {
+            error = task.m_handle.promise().error;
+        }
+    }
+    m_tasks.clear();
+    if (error) std::rethrow_exception(error);
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <vector>
+
+#include "RadarObj.h"
+
+// Turn pipeline
+// -------------
+// Arena turns are C++20 coroutines (Arena::playTurn, playRound and
+// playMatch return a Task). Every robot callback is preceded by a
+// co_await on the robot's answer: for an ordinary in-process robot the
+// answer is always there and nothing suspends, so driving a Task with
+// wait() plays exactly like the old blocking loop. A robot that answers
+// from elsewhere - another process, a worker thread - implements
+// AsyncRobot as well as RobotBase; while its answer is outstanding the
+// turn suspends, and a TurnScheduler running many arenas on one thread
+// plays the other arenas' turns meanwhile. Each arena still plays its
+// own turns strictly in order.
+
+// Optional second base for robots whose callbacks are answered
+// asynchronously. Before each RobotBase callback the arena calls
+// begin_call(); it only makes the callback once finished() is true, so
+// the callback just returns the answer that arrived.
+class AsyncRobot
+{
+public:
+    enum Call { RadarDirection, ProcessRadar, ShotLocation, MoveDirection };
+
+    virtual ~AsyncRobot() = default;
+
+    // Start computing the answer to call. radar is the scan for
+    // ProcessRadar and nullptr otherwise.
+    virtual void begin_call(Call call, const std::vector<RadarObj>* radar) = 0;
+
+    // Non-blocking: has the answer to the last begin_call() arrived?
+    virtual bool finished() = 0;
+
+    // Block until finished(); used when no scheduler is running.
+    virtual void wait() = 0;
+
+    // A descriptor that turns readable when the answer may have arrived,
+    // so an idle scheduler can poll() instead of spinning; -1 if none.
+    virtual int ready_fd() const { return -1; }
+
+    // Milliseconds until the answer is overdue and finished() gives up on
+    // it, so an idle scheduler wakes up in time to call it; -1 if never.
+    virtual int timeout_ms() const { return -1; }
+};
+
+// A lazily started coroutine returning nothing. co_await a Task from
+// another coroutine to run it as a subroutine, hand it to a TurnScheduler,
+// or call wait() to run it to the end on this thread.
+class Task
+{
+public:
+    struct promise_type;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    struct promise_type {
+        std::coroutine_handle<> continuation;
+        std::exception_ptr      error;
+
+        Task get_return_object() { return Task(Handle::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(Handle done) noexcept
+            {
+                auto next = done.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); }
+
+        // A turn allocates a few frames; recycle them per thread.
+        static void* operator new(std::size_t size);
+        static void  operator delete(void* frame, std::size_t size);
+    };
+
+    Task() = default;
+    Task(Task&& other) noexcept : m_handle(other.m_handle) { other.m_handle = {}; }
+    Task& operator=(Task&& other) noexcept;
+    ~Task();
+
+    bool done() const { return !m_handle || m_handle.done(); }
+
+    // Run to the end on this thread. Async robots are waited for in
+    // place, even if a scheduler is running.
+    void wait();
+
+    struct Awaiter {
+        Handle handle;
+
+        bool await_ready() const noexcept { return !handle || handle.done(); }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept
+        {
+            handle.promise().continuation = caller;
+            return handle;
+        }
+        void await_resume() const
+        {
+            if (handle && handle.promise().error) {
+                std::rethrow_exception(handle.promise().error);
+            }
+        }
+    };
+    Awaiter operator co_await() const& noexcept { return Awaiter{m_handle}; }
+
+private:
+    friend class TurnScheduler;
+    explicit Task(Handle handle) : m_handle(handle) {}
+
+    Handle m_handle;
+};
+
+// Runs many Tasks on the calling thread. A task runs until it finishes or
+// waits on an AsyncRobot; the scheduler then resumes other tasks, and the
+// waiting one once its robot has answered.
+class TurnScheduler
+{
+public:
+    TurnScheduler() = default;
+    TurnScheduler(const TurnScheduler&) = delete;
+    TurnScheduler& operator=(const TurnScheduler&) = delete;
+
+    // Queue a task; it starts on the next run().
+    void spawn(Task task);
+
+    // Run until every queued task has finished. Rethrows the first
+    // exception a task ended with.
+    void run();
+
+    // The scheduler whose run() is active on this thread, if any.
+    static TurnScheduler* current();
+
+    // Resume handle once robot has finished (called by RobotReply).
+    void park(std::coroutine_handle<> handle, AsyncRobot* robot);
+
+private:
+    struct Parked {
+        std::coroutine_handle<> handle;
+        AsyncRobot*             robot;
+    };
+
+    bool wake();
+
+    std::vector<Task>                    m_tasks;
+    std::vector<std::coroutine_handle<>> m_ready;
+    std::vector<Parked>                  m_parked;
+};
+
+// co_await RobotReply{robot} before a robot callback: ready at once for
+// in-process robots (robot == nullptr) and for async robots that have
+// already answered. Otherwise parks with the running scheduler, or blocks
+// in AsyncRobot::wait() when there is none.
+struct RobotReply {
+    AsyncRobot* robot;
+
+    bool await_ready() const { return !robot || robot->finished(); }
+    bool await_suspend(std::coroutine_handle<> caller) const
+    {
+        if (TurnScheduler* scheduler = TurnScheduler::current()) {
+            scheduler->park(caller, robot);
+            return true;
+        }
+        robot->wait();
+        return false;
+    }
+    void await_resume() const noexcept {}
+};
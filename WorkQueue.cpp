@@ -0,0 +1,496 @@
+#include "WorkQueue.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+std::vector<std::string> splitTabs(const std::string& line)
+{
+    std::vector<std::string> fields;
+    size_t start = 0;
+    for (;;) {
+        size_t tab = line.find('\t', start);
+        fields.push_back(line.substr(start, tab - start));
+        if (tab == std::string::npos) break;
+        start = tab + 1;
+    }
+    return fields;
+}
+
+// A socket address: "unix:/path" or "host:port".
+struct Endpoint {
+    bool        local = false;
+    std::string path;
+    std::string host;
+    std::string port;
+};
+
+Endpoint parseAddress(const std::string& address)
+{
+    Endpoint ep;
+    if (address.rfind("unix:", 0) == 0) {
+        ep.local = true;
+        ep.path  = address.substr(5);
+        if (ep.path.empty() || ep.path.size() >= sizeof(sockaddr_un::sun_path)) {
+            throw std::runtime_error("Bad socket path in " + address);
+        }
+        return ep;
+    }
+
+    size_t colon = address.rfind(':');
+    if (colon == std::string::npos || colon + 1 == address.size()) {
+        throw std::runtime_error("Address must be unix:/path or host:port, not " + address);
+    }
+    ep.host = address.substr(0, colon);
+    ep.port = address.substr(colon + 1);
+    return ep;
+}
+
+int openSocket(const std::string& address, bool listening)
+{
+    Endpoint ep = parseAddress(address);
+
+    if (ep.local) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) throw std::runtime_error("socket() failed");
+
+        sockaddr_un sa{};
+        sa.sun_family = AF_UNIX;
+        std::strncpy(sa.sun_path, ep.path.c_str(), sizeof(sa.sun_path) - 1);
+
+        int rc;
+        if (listening) {
+            unlink(ep.path.c_str());
+            rc = bind(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa));
+            if (rc == 0) rc = listen(fd, 64);
+        } else {
+            rc = connect(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa));
+        }
+        if (rc != 0) {
+            close(fd);
+            throw std::runtime_error("Cannot " + std::string(listening ? "listen on " : "connect to ") +
+                                     address + ": " + std::strerror(errno));
+        }
+        return fd;
+    }
+
+    addrinfo hints{};
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags    = listening ? AI_PASSIVE : 0;
+
+    addrinfo* found = nullptr;
+    const char* host = ep.host.empty() ? nullptr : ep.host.c_str();
+    if (getaddrinfo(host, ep.port.c_str(), &hints, &found) != 0) {
+        throw std::runtime_error("Cannot resolve " + address);
+    }
+
+    int fd = -1;
+    for (addrinfo* ai = found; ai && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) continue;
+
+        int rc;
+        if (listening) {
+            int on = 1;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+            rc = bind(fd, ai->ai_addr, ai->ai_addrlen);
+            if (rc == 0) rc = listen(fd, 64);
+        } else {
+            rc = connect(fd, ai->ai_addr, ai->ai_addrlen);
+        }
+        if (rc != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(found);
+
+    if (fd < 0) {
+        throw std::runtime_error("Cannot " + std::string(listening ? "listen on " : "connect to ") +
+                                 address + ": " + std::strerror(errno));
+    }
+    return fd;
+}
+
+bool sendLine(int fd, const std::string& line)
+{
+    std::string out = line + "\n";
+    size_t sent = 0;
+    while (sent < out.size()) {
+        ssize_t n = send(fd, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Buffered line reader over a socket.
+class LineReader {
+public:
+    explicit LineReader(int fd) : m_fd(fd) {}
+
+    // Pull whatever is available (one recv). Returns false on EOF/error.
+    bool fill()
+    {
+        char buf[65536];
+        ssize_t n;
+        do {
+            n = recv(m_fd, buf, sizeof(buf), 0);
+        } while (n < 0 && errno == EINTR);
+        if (n <= 0) return false;
+        m_buffer.append(buf, static_cast<size_t>(n));
+        return true;
+    }
+
+    bool takeLine(std::string& line)
+    {
+        size_t end = m_buffer.find('\n', m_offset);
+        if (end == std::string::npos) {
+            m_buffer.erase(0, m_offset);
+            m_offset = 0;
+            return false;
+        }
+        line.assign(m_buffer, m_offset, end - m_offset);
+        m_offset = end + 1;
+        return true;
+    }
+
+    // Block until a whole line is here.
+    bool readLine(std::string& line)
+    {
+        while (!takeLine(line)) {
+            if (!fill()) return false;
+        }
+        return true;
+    }
+
+private:
+    int         m_fd;
+    std::string m_buffer;
+    size_t      m_offset = 0;
+};
+}
+
+std::string encodeMatchRecord(const MatchRecord& rec)
+{
+    std::string out = std::to_string(rec.seed) + "\t" + std::to_string(rec.configHash) + "\t" +
+                      std::to_string(rec.wallNanos) + "\t" + std::to_string(rec.winner) + "\t" +
+                      std::to_string(rec.rounds);
+    for (const auto& r : rec.robots) {
+        const uint32_t values[] = {r.damageDealt, r.damageTaken, r.shots, r.moves,
+                                   r.pitEvents, r.flameEvents, r.survived, r.heapKb};
+        out += "\t" + r.name;
+        for (uint32_t v : values) {
+            out += "\t" + std::to_string(v);
+        }
+    }
+    return out;
+}
+
+bool decodeMatchRecord(const std::vector<std::string>& fields, size_t first,
+                       MatchRecord& rec)
+{
+    constexpr size_t perRobot = 9;
+    if (fields.size() < first + 5 || (fields.size() - first - 5) % perRobot != 0) {
+        return false;
+    }
+
+    try {
+        rec.seed       = std::stoull(fields[first]);
+        rec.configHash = std::stoull(fields[first + 1]);
+        rec.wallNanos  = std::stoull(fields[first + 2]);
+        rec.winner     = std::stoi(fields[first + 3]);
+        rec.rounds     = static_cast<uint32_t>(std::stoul(fields[first + 4]));
+
+        rec.robots.clear();
+        for (size_t i = first + 5; i < fields.size(); i += perRobot) {
+            RobotMatchStats r;
+            r.name        = fields[i];
+            r.damageDealt = static_cast<uint32_t>(std::stoul(fields[i + 1]));
+            r.damageTaken = static_cast<uint32_t>(std::stoul(fields[i + 2]));
+            r.shots       = static_cast<uint32_t>(std::stoul(fields[i + 3]));
+            r.moves       = static_cast<uint32_t>(std::stoul(fields[i + 4]));
+            r.pitEvents   = static_cast<uint32_t>(std::stoul(fields[i + 5]));
+            r.flameEvents = static_cast<uint32_t>(std::stoul(fields[i + 6]));
+            r.survived    = static_cast<uint32_t>(std::stoul(fields[i + 7]));
+            r.heapKb      = static_cast<uint32_t>(std::stoul(fields[i + 8]));
+            rec.robots.push_back(r);
+        }
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+    return rec.winner < static_cast<int32_t>(rec.robots.size());
+}
+
+// -------------------------------------------------------------------------
+// Coordinator
+
+struct Coordinator::Worker {
+    explicit Worker(int fd_) : fd(fd_), reader(fd_) {}
+    ~Worker() { close(fd); }
+
+    int        fd;
+    int        number = 0;
+    LineReader reader;
+    bool       welcomed = false;
+    bool       waiting  = false;        // asked for work while the queue was empty
+    bool       hasBatch = false;
+    Batch      batch{};
+    std::vector<MatchRecord> pending;   // results of batch so far
+};
+
+Coordinator::Coordinator(const std::string& address, uint64_t configHash,
+                         std::vector<std::string> roster,
+                         uint32_t firstSeed, uint64_t matches, uint32_t batchSize)
+    : m_address(address),
+      m_configHash(configHash),
+      m_roster(std::move(roster))
+{
+    if (batchSize == 0) batchSize = 1;
+
+    for (uint64_t done = 0; done < matches; done += batchSize) {
+        uint32_t count = static_cast<uint32_t>(std::min<uint64_t>(batchSize, matches - done));
+        m_queue.push_back(Batch{m_batches++, firstSeed + static_cast<uint32_t>(done), count});
+    }
+    std::reverse(m_queue.begin(), m_queue.end());
+
+    m_listenFd = openSocket(address, true);
+}
+
+Coordinator::~Coordinator()
+{
+    m_workers.clear();
+    if (m_listenFd >= 0) close(m_listenFd);
+
+    Endpoint ep = parseAddress(m_address);
+    if (ep.local) unlink(ep.path.c_str());
+}
+
+void Coordinator::run(const std::function<void(const MatchRecord&)>& onResult)
+{
+    std::cerr << "Coordinator on " << m_address << ": " << m_batches
+              << " batches to hand out\n";
+
+    std::vector<pollfd> fds;
+    while (m_finished < m_batches) {
+        fds.clear();
+        fds.push_back(pollfd{m_listenFd, POLLIN, 0});
+        for (const auto& w : m_workers) {
+            fds.push_back(pollfd{w->fd, POLLIN, 0});
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("poll() failed in coordinator");
+        }
+
+        // walk backwards so dropping a worker doesn't shift the rest
+        for (size_t i = fds.size() - 1; i >= 1; --i) {
+            if (!fds[i].revents) continue;
+            Worker& worker = *m_workers[i - 1];
+
+            bool alive = worker.reader.fill();
+            std::string line;
+            while (alive && worker.reader.takeLine(line)) {
+                alive = handleLine(worker, line, onResult);
+            }
+            if (!alive) {
+                drop(worker);
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            accept();
+        }
+    }
+
+    // Say DONE and wait (briefly) for each worker to hang up, so closing
+    // our end with their last READY unread doesn't reset the connection
+    // before DONE is delivered.
+    for (const auto& w : m_workers) {
+        sendLine(w->fd, "DONE");
+        shutdown(w->fd, SHUT_WR);
+    }
+    for (const auto& w : m_workers) {
+        pollfd pfd{w->fd, POLLIN, 0};
+        while (poll(&pfd, 1, 2000) > 0 && w->reader.fill()) {
+        }
+    }
+    std::cerr << "Coordinator: all " << m_batches << " batches finished\n";
+}
+
+void Coordinator::accept()
+{
+    int fd = ::accept(m_listenFd, nullptr, nullptr);
+    if (fd < 0) return;
+
+    m_workers.push_back(std::make_unique<Worker>(fd));
+    m_workers.back()->number = m_nextWorker++;
+}
+
+bool Coordinator::handleLine(Worker& worker, const std::string& line,
+                             const std::function<void(const MatchRecord&)>& onResult)
+{
+    std::vector<std::string> fields = splitTabs(line);
+    const std::string& verb = fields[0];
+
+    if (!worker.welcomed) {
+        if (verb != "HELLO" || fields.size() < 2) return false;
+
+        std::vector<std::string> roster(fields.begin() + 2, fields.end());
+        if (std::to_string(m_configHash) != fields[1] || roster != m_roster) {
+            std::cerr << "Worker " << worker.number
+                      << " rejected: different robots or arena settings\n";
+            sendLine(worker.fd, "BYE\troster or config mismatch");
+            return false;
+        }
+        worker.welcomed = true;
+        std::cerr << "Worker " << worker.number << " connected\n";
+        return sendLine(worker.fd, "WELCOME");
+    }
+
+    if (verb == "READY") {
+        dispatch(worker);
+        return true;
+    }
+
+    if (verb == "RESULT" && worker.hasBatch && fields.size() > 1 &&
+        fields[1] == std::to_string(worker.batch.id)) {
+        MatchRecord rec;
+        if (!decodeMatchRecord(fields, 2, rec)) return false;
+        worker.pending.push_back(std::move(rec));
+        return true;
+    }
+
+    if (verb == "FINISHED" && worker.hasBatch && fields.size() > 1 &&
+        fields[1] == std::to_string(worker.batch.id)) {
+        if (worker.pending.size() != worker.batch.count) return false;
+
+        for (const auto& rec : worker.pending) {
+            onResult(rec);
+        }
+        worker.pending.clear();
+        worker.hasBatch = false;
+        ++m_finished;
+        return true;
+    }
+
+    std::cerr << "Worker " << worker.number << ": unexpected message '"
+              << verb << "'\n";
+    return false;
+}
+
+void Coordinator::dispatch(Worker& worker)
+{
+    if (m_queue.empty()) {
+        // everything is handed out; hold the worker in case a batch is
+        // requeued, or until DONE
+        worker.waiting = true;
+        return;
+    }
+
+    worker.batch    = m_queue.back();
+    worker.hasBatch = true;
+    worker.waiting  = false;
+    m_queue.pop_back();
+
+    sendLine(worker.fd, "BATCH\t" + std::to_string(worker.batch.id) + "\t" +
+                        std::to_string(worker.batch.firstSeed) + "\t" +
+                        std::to_string(worker.batch.count));
+}
+
+void Coordinator::drop(Worker& worker)
+{
+    if (worker.hasBatch) {
+        std::cerr << "Worker " << worker.number << " lost; requeued the "
+                  << worker.batch.count << " matches from seed "
+                  << worker.batch.firstSeed << "\n";
+        m_queue.push_back(worker.batch);
+    } else if (worker.welcomed) {
+        std::cerr << "Worker " << worker.number << " disconnected\n";
+    }
+
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        if (m_workers[i].get() == &worker) {
+            m_workers.erase(m_workers.begin() + static_cast<long>(i));
+            break;
+        }
+    }
+
+    // give a requeued batch to a worker that is idle
+    for (const auto& w : m_workers) {
+        if (m_queue.empty()) break;
+        if (w->waiting) dispatch(*w);
+    }
+}
+
+// -------------------------------------------------------------------------
+// Worker
+
+bool runWorker(const std::string& address, const std::vector<RegisteredRobot>& roster,
+               uint64_t configHash, const BatchOptions& options)
+{
+    int fd = openSocket(address, false);
+    LineReader reader(fd);
+
+    std::string hello = "HELLO\t" + std::to_string(configHash);
+    for (const auto& robot : roster) {
+        hello += "\t" + robot.source;
+    }
+
+    std::string line;
+    if (!sendLine(fd, hello) || !reader.readLine(line) || line != "WELCOME") {
+        std::cerr << "Coordinator refused this worker"
+                  << (line.empty() ? "" : ": " + line) << "\n";
+        close(fd);
+        return false;
+    }
+
+    uint64_t played = 0;
+    bool ok = true;
+    while (ok) {
+        if (!sendLine(fd, "READY") || !reader.readLine(line)) {
+            std::cerr << "Lost the coordinator\n";
+            ok = false;
+            break;
+        }
+
+        std::vector<std::string> fields = splitTabs(line);
+        if (fields[0] == "DONE") break;
+        if (fields[0] != "BATCH" || fields.size() != 4) {
+            std::cerr << "Unexpected message from coordinator: " << line << "\n";
+            ok = false;
+            break;
+        }
+
+        BatchOptions batch = options;
+        batch.firstSeed = static_cast<uint32_t>(std::stoul(fields[2]));
+        batch.matches   = std::stoull(fields[3]);
+
+        std::string prefix = "RESULT\t" + fields[1] + "\t";
+        BatchRunner runner(roster, batch);
+        runner.run([&](const MatchRecord& rec) {
+            ok = ok && sendLine(fd, prefix + encodeMatchRecord(rec));
+        });
+        ok = ok && sendLine(fd, "FINISHED\t" + fields[1]);
+        played += batch.matches;
+    }
+
+    close(fd);
+    std::cerr << "Worker finished: played " << played << " matches\n";
+    return ok;
+}
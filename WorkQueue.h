@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ResultsStore.h"
+#include "RobotRegistry.h"
+#include "BatchRunner.h"
+
+// Tournament coordinator and workers over a socket.
+//
+// The coordinator owns the seed queue and the results; workers connect,
+// pull batches of consecutive seeds, play them with a BatchRunner and
+// stream the records back. Addresses are "unix:/path/to.sock" or
+// "host:port" (TCP), so the same protocol works across machines.
+//
+// Protocol: one tab-separated line per message.
+//
+//   worker      -> coordinator   HELLO  configHash  source...
+//   coordinator -> worker        WELCOME | BYE reason
+//   worker      -> coordinator   READY
+//   coordinator -> worker        BATCH  id  firstSeed  count | DONE
+//   worker      -> coordinator   RESULT id  <record>        (count times)
+//                                FINISHED id
+//
+// where <record> is seed, configHash, wallNanos, winner, rounds and then
+// name, damageDealt, damageTaken, shots, moves, pitEvents, flameEvents,
+// survived, heapKb for each robot. A batch only counts once FINISHED
+// arrives; if the worker disconnects before that, its partial results are
+// dropped and the batch goes back to the front of the queue.
+
+std::string encodeMatchRecord(const MatchRecord& record);
+bool        decodeMatchRecord(const std::vector<std::string>& fields,
+                              size_t first, MatchRecord& record);
+
+class Coordinator {
+public:
+    // roster: the robots' source names, which workers must match along
+    // with configHash.
+    Coordinator(const std::string& address, uint64_t configHash,
+                std::vector<std::string> roster,
+                uint32_t firstSeed, uint64_t matches, uint32_t batchSize);
+    ~Coordinator();
+
+    Coordinator(const Coordinator&) = delete;
+    Coordinator& operator=(const Coordinator&) = delete;
+
+    // Serve workers until every batch is finished. onResult gets each
+    // record of a finished batch.
+    void run(const std::function<void(const MatchRecord&)>& onResult);
+
+private:
+    struct Batch {
+        uint64_t id;
+        uint32_t firstSeed;
+        uint32_t count;
+    };
+    struct Worker;
+
+    void accept();
+    bool handleLine(Worker& worker, const std::string& line,
+                    const std::function<void(const MatchRecord&)>& onResult);
+    void dispatch(Worker& worker);
+    void drop(Worker& worker);
+
+    std::string              m_address;
+    uint64_t                 m_configHash;
+    std::vector<std::string> m_roster;
+    int                      m_listenFd = -1;
+
+    std::vector<Batch>       m_queue;          // next batch at the back
+    uint64_t                 m_batches   = 0;
+    uint64_t                 m_finished  = 0;
+    int                      m_nextWorker = 1;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+};
+
+// Connect to a coordinator and play batches until it says DONE. roster and
+// configHash must match the coordinator's. Returns false on a connection
+// or protocol error.
+bool runWorker(const std::string& address, const std::vector<RegisteredRobot>& roster,
+               uint64_t configHash, const BatchOptions& options);
@@ -0,0 +1,144 @@
+// rwbench.cpp - rounds per second for large free-for-all matches.
+#include "Arena.h"
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+void usage(const char* prog)
+{
+    std::cerr << "Usage: " << prog << " [--robots N,N,...] [--rounds R]\n"
+              << "       [--cells-per-robot C] [--seed S]\n"
+              << "  --robots N,...  match sizes to time (default 10,100,1000,10000)\n"
+              << "  --rounds R      rounds to time per size, over as many matches\n"
+              << "                  as it takes (default 200)\n"
+              << "  --cells-per-robot C  board area per robot; obstacles scale\n"
+              << "                  with it as on the default 20x20 board (default 40)\n"
+              << "  --seed S        first match seed (default 1)\n";
+}
+
+std::vector<int> parseSizes(const std::string& list)
+{
+    std::vector<int> sizes;
+    std::stringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        int n = std::atoi(item.c_str());
+        if (n < 1) return {};
+        sizes.push_back(n);
+    }
+    return sizes;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<int> sizes = {10, 100, 1000, 10000};
+    int      rounds        = 200;
+    int      cellsPerRobot = 40;
+    uint32_t seed          = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool more = i + 1 < argc;
+        if (arg == "--robots" && more) {
+            sizes = parseSizes(argv[++i]);
+        } else if (arg == "--rounds" && more) {
+            rounds = std::atoi(argv[++i]);
+        } else if (arg == "--cells-per-robot" && more) {
+            cellsPerRobot = std::atoi(argv[++i]);
+        } else if (arg == "--seed" && more) {
+            seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (sizes.empty() || rounds < 1 || cellsPerRobot < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        ArenaConfig loaderConfig;
+        loaderConfig.watchLive = false;
+        Arena loader(loaderConfig);
+        loader.loadRobots();
+        std::vector<RegisteredRobot> roster = loader.roster();
+        if (roster.empty()) {
+            std::cerr << "No robots to play with.\n";
+            return 1;
+        }
+
+        std::cout << std::setw(8) << "robots" << std::setw(11) << "board"
+                  << std::setw(9) << "matches" << std::setw(8) << "rounds"
+                  << std::setw(12) << "rounds/s" << std::setw(14) << "turns/s"
+                  << std::setw(12) << "setup ms" << "\n";
+
+        for (int n : sizes) {
+            // the default board gives 20x20 = 400 cells to 5 mounds, 3 pits
+            // and 3 flamers; keep that density as the board grows
+            int side  = std::max(20, static_cast<int>(std::ceil(std::sqrt(double(n) * cellsPerRobot))));
+            int cells = side * side;
+
+            ArenaConfig config;
+            config.rows       = side;
+            config.cols       = side;
+            config.numMounds  = 5 * cells / 400;
+            config.numPits    = 3 * cells / 400;
+            config.numFlamers = 3 * cells / 400;
+            config.maxRounds  = rounds;
+            config.watchLive  = false;
+            config.seed       = seed;
+
+            auto setupStart = std::chrono::steady_clock::now();
+            Arena arena(config);
+            for (int i = 0; i < n; ++i) {
+                arena.addRobot(roster[i % roster.size()]);
+            }
+            arena.newMatch(seed);
+            double setupMs = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - setupStart).count();
+
+            using Clock = std::chrono::steady_clock;
+            Clock::duration timed{};
+            long   played  = 0;
+            double turns   = 0;
+            int    matches = 1;
+
+            while (played < rounds) {
+                if (arena.matchOver()) {
+                    arena.newMatch(seed + static_cast<uint32_t>(matches++));
+                }
+
+                bool more = true;
+                while (more && played < rounds) {
+                    turns += arena.aliveRobots();
+                    auto start = Clock::now();
+                    more = arena.stepRound();
+                    timed += Clock::now() - start;
+                    ++played;
+                }
+            }
+
+            double seconds = std::chrono::duration<double>(timed).count();
+            std::ostringstream board;
+            board << side << "x" << side;
+            std::cout << std::setw(8) << n << std::setw(11) << board.str()
+                      << std::setw(9) << matches << std::setw(8) << played
+                      << std::setw(12) << std::fixed << std::setprecision(1) << played / seconds
+                      << std::setw(14) << std::setprecision(0) << turns / seconds
+                      << std::setw(12) << std::setprecision(1) << setupMs << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
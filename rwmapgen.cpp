@@ -0,0 +1,107 @@
+// rwmapgen.cpp - build a map pack for RobotWarz --maps.
+#include "MapPack.h"
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+namespace {
+void usage(const char* prog)
+{
+    std::cerr << "Usage: " << prog << " <map pack> [--maps N] [--rows R] [--cols C]\n"
+              << "       [--style scatter|clusters|corridors|symmetric|mixed]\n"
+              << "       [--mounds M] [--pits P] [--flamers F]\n"
+              << "       [--spawns S] [--min-separation D] [--show I]\n";
+}
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    MapGenOptions options;
+    int maps = 1000;
+    int show = -1;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool more = i + 1 < argc;
+        if (arg == "--maps" && more) {
+            maps = std::atoi(argv[++i]);
+        } else if (arg == "--rows" && more) {
+            options.rows = std::atoi(argv[++i]);
+        } else if (arg == "--cols" && more) {
+            options.cols = std::atoi(argv[++i]);
+        } else if (arg == "--mounds" && more) {
+            options.mounds = std::atoi(argv[++i]);
+        } else if (arg == "--pits" && more) {
+            options.pits = std::atoi(argv[++i]);
+        } else if (arg == "--flamers" && more) {
+            options.flamers = std::atoi(argv[++i]);
+        } else if (arg == "--spawns" && more) {
+            options.spawns = std::atoi(argv[++i]);
+        } else if (arg == "--min-separation" && more) {
+            options.minSpawnSeparation = std::atoi(argv[++i]);
+        } else if (arg == "--show" && more) {
+            show = std::atoi(argv[++i]);
+        } else if (arg == "--style" && more) {
+            std::string name = argv[++i];
+            int s = 0;
+            while (s < MapGenOptions::NumStyles &&
+                   name != mapStyleName(static_cast<MapGenOptions::Style>(s))) {
+                ++s;
+            }
+            if (s == MapGenOptions::NumStyles) {
+                usage(argv[0]);
+                return 1;
+            }
+            options.style = static_cast<MapGenOptions::Style>(s);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (maps < 1 || options.rows < 10 || options.cols < 10 ||
+        options.spawns < 0 || options.rows > 65535 || options.cols > 65535) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<GeneratedMap> pack(maps);
+    try {
+        for (int m = 0; m < maps; ++m) {
+            if (!generateMap(options, static_cast<uint32_t>(m), pack[m])) {
+                std::cerr << "Map " << m << ": could not place " << options.spawns
+                          << " connected spawns " << options.minSpawnSeparation
+                          << " apart; try fewer obstacles or spawns.\n";
+                return 1;
+            }
+        }
+        writeMapPack(argv[1], options, pack);
+    }
+    catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+
+    std::cout << "Wrote " << maps << " " << options.rows << "x" << options.cols
+              << " " << mapStyleName(options.style) << " maps to " << argv[1] << "\n";
+
+    if (show >= 0 && show < maps) {
+        GeneratedMap& map = pack[show];
+        for (const auto& s : map.spawns) {
+            map.cells[s.row * options.cols + s.col] = 'S';
+        }
+        for (int r = 0; r < options.rows; ++r) {
+            for (int c = 0; c < options.cols; ++c) {
+                std::cout << ' ' << map.cells[r * options.cols + c];
+            }
+            std::cout << "\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+// rwquery.cpp - summarize a RobotWarz results file in one streaming pass.
+#include "ResultsStore.h"
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <string>
+#include <cstdlib>
+
+namespace {
+struct RobotTotals {
+    uint64_t matches = 0;
+    uint64_t wins    = 0;
+    uint64_t survived = 0;
+    uint64_t damageDealt = 0;
+    uint64_t damageTaken = 0;
+    uint64_t shots       = 0;
+    uint64_t moves       = 0;
+    uint64_t pitEvents   = 0;
+    uint64_t flameEvents = 0;
+    uint64_t heapKb      = 0;
+    uint32_t peakHeapKb  = 0;
+};
+
+void usage(const char* prog)
+{
+    std::cerr << "Usage: " << prog << " <results file> [--config HASH]\n";
+}
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    bool     filterConfig = false;
+    uint64_t config       = 0;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--config" && i + 1 < argc) {
+            filterConfig = true;
+            config = std::strtoull(argv[++i], nullptr, 0);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    uint64_t matches = 0;
+    uint64_t draws   = 0;
+    uint64_t rounds  = 0;
+    uint64_t wallNanos = 0;
+    std::map<std::string, RobotTotals> robots;
+
+    try {
+        ResultsReader reader(argv[1]);
+        ResultsGroup  group;
+        while (reader.nextGroup(group)) {
+            for (uint32_t m = 0; m < group.matches; ++m) {
+                if (filterConfig && group.configHash[m] != config) continue;
+
+                ++matches;
+                rounds    += group.rounds[m];
+                wallNanos += group.wallNanos[m];
+                if (group.winner[m] < 0) ++draws;
+
+                uint32_t first = group.firstRobot[m];
+                for (uint32_t k = 0; k < group.robotCount[m]; ++k) {
+                    uint32_t row = first + k;
+                    auto& t = robots[group.robotName(row)];
+                    ++t.matches;
+                    if (group.winner[m] == static_cast<int32_t>(k)) ++t.wins;
+                    t.survived    += group.survived[row];
+                    t.damageDealt += group.damageDealt[row];
+                    t.damageTaken += group.damageTaken[row];
+                    t.shots       += group.shots[row];
+                    t.moves       += group.moves[row];
+                    t.pitEvents   += group.pitEvents[row];
+                    t.flameEvents += group.flameEvents[row];
+                    t.heapKb      += group.heapKb[row];
+                    t.peakHeapKb   = std::max(t.peakHeapKb, group.heapKb[row]);
+                }
+            }
+        }
+    }
+    catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+
+    if (matches == 0) {
+        std::cout << "No matches.\n";
+        return 0;
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "matches: " << matches
+              << "  draws: " << 100.0 * draws / matches << "%"
+              << "  avg rounds: " << double(rounds) / matches
+              << "  avg wall: " << wallNanos / 1000.0 / matches << " us\n\n";
+
+    std::cout << std::left << std::setw(24) << "robot" << std::right
+              << std::setw(9) << "matches" << std::setw(9) << "win %"
+              << std::setw(10) << "dealt" << std::setw(10) << "taken"
+              << std::setw(9) << "shots" << std::setw(9) << "moves"
+              << std::setw(8) << "pits" << std::setw(8) << "flames"
+              << std::setw(10) << "heap kB" << std::setw(10) << "max kB" << "\n";
+
+    for (const auto& [name, t] : robots) {
+        double n = static_cast<double>(t.matches);
+        std::cout << std::left << std::setw(24) << name << std::right
+                  << std::setw(9) << t.matches
+                  << std::setw(9) << 100.0 * t.wins / n
+                  << std::setw(10) << t.damageDealt / n
+                  << std::setw(10) << t.damageTaken / n
+                  << std::setw(9) << t.shots / n
+                  << std::setw(9) << t.moves / n
+                  << std::setw(8) << t.pitEvents / n
+                  << std::setw(8) << t.flameEvents / n
+                  << std::setw(10) << t.heapKb / n
+                  << std::setw(10) << t.peakHeapKb << "\n";
+    }
+
+    return 0;
+}
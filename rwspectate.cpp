@@ -0,0 +1,231 @@
+// rwspectate.cpp - watch a RobotWarz --spectate feed from another terminal,
+// or play back a RobotWarz --replay file.
+#include "SpectatorFeed.h"
+#include "FrameCodec.h"
+#include "Replay.h"
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+
+namespace {
+void usage(const char* prog)
+{
+    std::cerr << "Usage: " << prog << " <feed name> [--fps N] [--stats]\n"
+              << "       " << prog << " --replay FILE [--fps N] [--stats]\n"
+              << "  --fps N   redraw at most N times a second (default 10); a\n"
+              << "            replay shows every turn at N turns a second\n"
+              << "  --stats   print frame rate and drops instead of the board; for\n"
+              << "            a replay, the frame and byte counts\n";
+}
+
+void drawBoard(const FeedView& key, const FeedView& now, uint32_t rows, uint32_t cols,
+               uint64_t frames, uint64_t dropped)
+{
+    std::vector<char> board(key.terrain, key.terrain + size_t(rows) * cols);
+    for (int i = 0; i < now.frame->robots; ++i) {
+        const FeedRobot& r = now.robots[i];
+        if (r.row >= rows || r.col >= cols) continue;
+        board[r.row * cols + r.col] = (r.flags & FeedRobot::Alive) ? r.symbol : 'X';
+    }
+
+    std::cout << "\033[H\033[2J"
+              << "match " << now.frame->match << "  seed " << now.frame->seed
+              << "  round " << now.frame->round
+              << "    frames " << frames << "  dropped " << dropped << "\n\n";
+
+    for (uint32_t r = 0; r < rows; ++r) {
+        for (uint32_t c = 0; c < cols; ++c) {
+            std::cout << ' ' << board[r * cols + c];
+        }
+        std::cout << "\n";
+    }
+    std::cout << "\n";
+
+    for (int i = 0; i < now.frame->robots; ++i) {
+        const FeedRobot& r = now.robots[i];
+        std::cout << "  " << std::left << std::setw(24) << key.robotName(i) << std::right
+                  << " health " << std::setw(4) << r.health
+                  << "  armor " << std::setw(2) << r.armor
+                  << ((r.flags & FeedRobot::Alive) ? "" : "  out")
+                  << ((r.flags & FeedRobot::InPit) ? "  in pit" : "") << "\n";
+    }
+    std::cout << std::flush;
+}
+
+int playReplay(const std::string& path, int fps, bool stats)
+{
+    ReplayReader replay(path);
+    const auto interval = std::chrono::microseconds(1000000 / fps);
+
+    std::vector<unsigned char> payload;
+    std::vector<char>          names, terrain;
+    FrameDecoder               decoder;
+    FeedView                   key, now;
+    ReplayReader::Type         type;
+
+    uint64_t matches = 0, frames = 0, keyFrames = 0, bad = 0;
+    uint64_t bytes = 0, rawBytes = 0;
+
+    while (replay.next(type, payload)) {
+        bytes += payload.size();
+
+        if (type == ReplayReader::Match) {
+            if (!replay.parseMatch(payload, names, terrain)) {
+                std::cerr << "Error: bad match record in " << path << "\n";
+                return 1;
+            }
+            key.names   = names.data();
+            key.terrain = terrain.data();
+            ++matches;
+            continue;
+        }
+
+        if (!decoder.decode(payload.data(), payload.size())) {
+            ++bad;
+            continue;
+        }
+        ++frames;
+        keyFrames += decoder.lastWasKey();
+        rawBytes  += sizeof(FeedFrame) + sizeof(FeedRobot) * decoder.robots().size();
+
+        if (stats || !key.terrain) continue;
+
+        now.frame  = &decoder.frame();
+        now.robots = decoder.robots().data();
+        if (names.size() < decoder.robots().size() * feedNameBytes) continue;
+        drawBoard(key, now, replay.rows(), replay.cols(), frames, bad);
+        std::this_thread::sleep_for(interval);
+    }
+
+    std::cout << "Replay of " << matches << " matches, " << frames << " frames ("
+              << keyFrames << " key frames";
+    if (bad) std::cout << ", " << bad << " undecodable";
+    std::cout << ")";
+    if (stats && frames) {
+        std::cout << ": " << bytes << " bytes, " << std::fixed << std::setprecision(1)
+                  << double(bytes) / frames << " per frame, "
+                  << double(rawBytes) / frames << " raw";
+    }
+    std::cout << ".\n";
+    return 0;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::string feedName = argv[1];
+    std::string replayPath;
+    int first = 2;
+    if (feedName == "--replay") {
+        if (argc < 3) {
+            usage(argv[0]);
+            return 1;
+        }
+        replayPath = argv[2];
+        first = 3;
+    }
+
+    int  fps   = 10;
+    bool stats = false;
+    for (int i = first; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--fps" && i + 1 < argc) {
+            fps = std::atoi(argv[++i]);
+        } else if (arg == "--stats") {
+            stats = true;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (fps < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        if (!replayPath.empty()) {
+            return playReplay(replayPath, fps, stats);
+        }
+
+        SpectatorView view(feedName);
+
+        using Clock = std::chrono::steady_clock;
+        const auto interval = std::chrono::microseconds(1000000 / fps);
+
+        // every ring frame goes through the decoder, which drops deltas
+        // after a gap until the next key frame
+        std::vector<unsigned char> bytes, keyBytes;
+        FrameDecoder decoder;
+        FeedView now, key;
+        bool     haveKey = false;
+        uint64_t frames  = 0;
+        uint64_t lastFrames = 0;
+        uint64_t frameBytes = 0;
+        uint64_t lastBytes  = 0;
+        auto     lastDraw   = Clock::now();
+
+        for (;;) {
+            bool fresh = false;
+            while (view.next(bytes)) {
+                decoder.decode(bytes.data(), bytes.size());
+                frameBytes += bytes.size();
+                ++frames;
+                fresh = true;
+            }
+
+            if (!fresh) {
+                if (view.writerClosed() && !view.next(bytes)) break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+
+            auto tick = Clock::now();
+            if (tick - lastDraw < interval) continue;
+
+            if (stats) {
+                double seconds = std::chrono::duration<double>(tick - lastDraw).count();
+                std::cout << "frames/s " << std::fixed << std::setprecision(0)
+                          << (frames - lastFrames) / seconds
+                          << "  bytes/frame " << std::setprecision(1)
+                          << (frames > lastFrames ? double(frameBytes - lastBytes) / (frames - lastFrames) : 0.0)
+                          << "  total " << frames << "  dropped " << view.dropped() << "\n";
+                lastFrames = frames;
+                lastBytes  = frameBytes;
+                lastDraw   = tick;
+                continue;
+            }
+
+            if (!decoder.ready()) continue;
+            now.frame  = &decoder.frame();
+            now.robots = decoder.robots().data();
+            if (!haveKey || key.frame->match != now.frame->match) {
+                haveKey = view.key(keyBytes) &&
+                          parseFeedFrame(keyBytes, view.rows(), view.cols(), key) &&
+                          key.frame->match == now.frame->match &&
+                          key.frame->robots == now.frame->robots;
+            }
+            if (haveKey) {
+                drawBoard(key, now, view.rows(), view.cols(), frames, view.dropped());
+                lastDraw = tick;
+            }
+        }
+
+        std::cout << "Feed closed after " << frames << " frames ("
+                  << view.dropped() << " dropped).\n";
+    }
+    catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -1,7 +1,16 @@
 #include "RobotBase.h"
+#include "AllocHooks.h"
 #include <iostream>
+#include <iomanip>
+#include <fstream>
 #include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cstdlib>
 #include <dlfcn.h>
+#include <unistd.h>
+#include <sys/resource.h>
 #include <algorithm>
 
 RobotBase* load_robot(const std::string& shared_lib, void* &handle) 
@@ -140,14 +149,329 @@ void test_robot_behavior(RobotBase* robot)
 }
 
 
+// ---------------------------------------------------------------------------
+// Profiler mode: instead of 10 scripted turns, drive the robot through
+// thousands of randomized radar scenarios on a large board and measure
+// what each callback costs. Robots that are too slow, allocate on every
+// call, or keep growing are rejected before they reach the arena.
+
+struct ProfileOptions
+{
+    int      scenarios = 10000;
+    int      rows      = 100;
+    int      cols      = 100;
+    unsigned seed      = 1;
+
+    // rejection thresholds; negative means "don't check"
+    double maxP99Us          = -1;
+    double maxAllocsPerCall  = -1;
+    long   maxRssGrowthKb    = -1;
+};
+
+struct CallbackProfile
+{
+    const char*           name;
+    std::vector<uint64_t> nanos;
+    AllocStats            allocs;
+};
+
+// time one callback and charge its heap allocations to it
+template <typename Fn>
+void measure(CallbackProfile& profile, Fn&& fn)
+{
+    AllocStats before = threadAllocStats();
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto stop = std::chrono::steady_clock::now();
+    AllocStats used = threadAllocStats() - before;
+
+    profile.nanos.push_back(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+    profile.allocs.calls += used.calls;
+    profile.allocs.bytes += used.bytes;
+}
+
+long current_rss_kb()
+{
+    std::ifstream statm("/proc/self/statm");
+    long size = 0, resident = 0;
+    statm >> size >> resident;
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+long peak_rss_kb()
+{
+    struct rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// A random board plus some enemy robots, scanned with the same 3-wide
+// radar rules the arena uses.
+class ScenarioBoard
+{
+public:
+    ScenarioBoard(int rows, int cols, unsigned seed)
+        : m_rows(rows), m_cols(cols), m_cells(rows * cols, '.'), m_rng(seed)
+    {
+        // roughly 3% mounds, 1% pits, 1% flamers
+        std::uniform_int_distribution<int> pct(0, 99);
+        for (char& cell : m_cells) {
+            int roll = pct(m_rng);
+            if (roll < 3)      cell = 'M';
+            else if (roll < 4) cell = 'P';
+            else if (roll < 5) cell = 'F';
+        }
+
+        int enemies = std::max(4, rows * cols / 400);
+        for (int i = 0; i < enemies; ++i) {
+            m_enemies.push_back(random_cell());
+        }
+    }
+
+    // teleport the robot under test, and shuffle a few enemies (some die)
+    void next(RobotBase* robot)
+    {
+        int cell = random_cell();
+        m_row = cell / m_cols;
+        m_col = cell % m_cols;
+        robot->move_to(m_row, m_col);
+
+        std::uniform_int_distribution<size_t> pick(0, m_enemies.size() - 1);
+        for (int i = 0; i < 2; ++i) {
+            m_enemies[pick(m_rng)] = random_cell();
+        }
+        std::uniform_int_distribution<int> pct(0, 99);
+        if (pct(m_rng) < 5) {
+            m_dead.push_back(m_enemies[pick(m_rng)]);
+        }
+    }
+
+    std::vector<RadarObj> radar(int direction) const
+    {
+        std::vector<RadarObj> results;
+
+        auto add_cell = [&](int r, int c) {
+            if (r < 0 || r >= m_rows || c < 0 || c >= m_cols) return;
+            if (r == m_row && c == m_col) return;
+
+            int  index = r * m_cols + c;
+            char ch    = m_cells[index];
+            if (std::find(m_dead.begin(), m_dead.end(), index) != m_dead.end()) {
+                ch = 'X';
+            } else if (std::find(m_enemies.begin(), m_enemies.end(), index) != m_enemies.end()) {
+                ch = 'R';
+            }
+            // the arena reports every cell of the ray, empty ones too
+            results.emplace_back(ch, r, c);
+        };
+
+        if (direction == 0) {
+            for (int dr = -1; dr <= 1; ++dr)
+                for (int dc = -1; dc <= 1; ++dc)
+                    add_cell(m_row + dr, m_col + dc);
+            return results;
+        }
+        if (direction < 1 || direction > 8) return results;
+
+        int dr = directions[direction].first;
+        int dc = directions[direction].second;
+        int r  = m_row + dr;
+        int c  = m_col + dc;
+        while (r >= 0 && r < m_rows && c >= 0 && c < m_cols) {
+            add_cell(r, c);
+            add_cell(r - dc, c + dr);
+            add_cell(r + dc, c - dr);
+            r += dr;
+            c += dc;
+        }
+        return results;
+    }
+
+private:
+    int random_cell()
+    {
+        std::uniform_int_distribution<int> dist(0, m_rows * m_cols - 1);
+        int cell;
+        do {
+            cell = dist(m_rng);
+        } while (m_cells[cell] == 'M');
+        return cell;
+    }
+
+    int               m_rows;
+    int               m_cols;
+    std::vector<char> m_cells;
+    std::vector<int>  m_enemies;
+    std::vector<int>  m_dead;
+    std::mt19937      m_rng;
+    int               m_row = 0;
+    int               m_col = 0;
+};
+
+double percentile_us(std::vector<uint64_t> sorted, double pct)
+{
+    if (sorted.empty()) return 0.0;
+    size_t index = static_cast<size_t>(pct / 100.0 * (sorted.size() - 1));
+    return sorted[index] / 1000.0;
+}
+
+// returns 0 if the robot passes, 2 if it should be rejected
+int profile_robot(RobotBase* robot, const ProfileOptions& opts)
+{
+    robot->set_boundaries(opts.rows, opts.cols);
+    ScenarioBoard board(opts.rows, opts.cols, opts.seed);
+
+    CallbackProfile radar_dir{"get_radar_direction", {}, {}};
+    CallbackProfile process{"process_radar_results", {}, {}};
+    CallbackProfile shot{"get_shot_location", {}, {}};
+    CallbackProfile move{"get_move_direction", {}, {}};
+    for (auto* p : {&radar_dir, &process, &shot, &move}) {
+        p->nanos.reserve(opts.scenarios);
+    }
+
+    int  bad_radar = 0;
+    int  bad_move  = 0;
+    int  warmup    = std::max(1, opts.scenarios / 10);
+    long rss_after_warmup = 0;
+
+    std::cout << "Profiling " << opts.scenarios << " scenarios on a "
+              << opts.rows << "x" << opts.cols << " board (seed " << opts.seed << ")...\n";
+
+    for (int i = 0; i < opts.scenarios; ++i) {
+        if (i == warmup) {
+            rss_after_warmup = current_rss_kb();
+        }
+
+        board.next(robot);
+
+        int direction = 0;
+        measure(radar_dir, [&] { robot->get_radar_direction(direction); });
+        if (direction < 0 || direction > 8) {
+            ++bad_radar;
+        }
+
+        std::vector<RadarObj> results = board.radar(direction);
+        measure(process, [&] { robot->process_radar_results(results); });
+
+        int  shot_row = 0, shot_col = 0;
+        bool shoots   = false;
+        measure(shot, [&] { shoots = robot->get_shot_location(shot_row, shot_col); });
+
+        if (!shoots) {
+            int move_dir = 0, distance = 0;
+            measure(move, [&] { robot->get_move_direction(move_dir, distance); });
+            if (move_dir < 0 || move_dir > 8 || distance < 0) {
+                ++bad_move;
+            }
+        }
+    }
+
+    long rss_end    = current_rss_kb();
+    long rss_growth = rss_after_warmup ? rss_end - rss_after_warmup : 0;
+
+    std::cout << "\n" << std::left << std::setw(24) << "callback"
+              << std::right << std::setw(9) << "calls"
+              << std::setw(10) << "p50 us" << std::setw(10) << "p90 us"
+              << std::setw(10) << "p99 us" << std::setw(10) << "p99.9 us"
+              << std::setw(10) << "max us"
+              << std::setw(13) << "allocs/call" << std::setw(13) << "bytes/call" << "\n";
+
+    bool   reject    = false;
+    double worst_p99 = 0;
+    double worst_allocs = 0;
+    for (auto* p : {&radar_dir, &process, &shot, &move}) {
+        std::vector<uint64_t> sorted = p->nanos;
+        std::sort(sorted.begin(), sorted.end());
+        double calls  = std::max<size_t>(1, sorted.size());
+        double p99    = percentile_us(sorted, 99);
+        double allocs = p->allocs.calls / calls;
+
+        worst_p99    = std::max(worst_p99, p99);
+        worst_allocs = std::max(worst_allocs, allocs);
+
+        std::cout << std::left << std::setw(24) << p->name << std::right
+                  << std::setw(9) << sorted.size() << std::fixed << std::setprecision(2)
+                  << std::setw(10) << percentile_us(sorted, 50)
+                  << std::setw(10) << percentile_us(sorted, 90)
+                  << std::setw(10) << p99
+                  << std::setw(10) << percentile_us(sorted, 99.9)
+                  << std::setw(10) << (sorted.empty() ? 0.0 : sorted.back() / 1000.0)
+                  << std::setw(13) << allocs
+                  << std::setw(13) << p->allocs.bytes / calls << "\n";
+    }
+
+    std::cout << "\nRSS after warmup: " << rss_after_warmup << " KB, at end: " << rss_end
+              << " KB (growth " << rss_growth << " KB), peak: " << peak_rss_kb() << " KB\n";
+
+    if (bad_radar || bad_move) {
+        std::cerr << "Conformance: " << bad_radar << " radar directions and " << bad_move
+                  << " moves out of range (directions must be 0-8, distance >= 0)\n";
+        reject = true;
+    }
+    if (opts.maxP99Us >= 0 && worst_p99 > opts.maxP99Us) {
+        std::cerr << "Latency: worst p99 " << worst_p99 << " us exceeds " << opts.maxP99Us << " us\n";
+        reject = true;
+    }
+    if (opts.maxAllocsPerCall >= 0 && worst_allocs > opts.maxAllocsPerCall) {
+        std::cerr << "Allocations: " << worst_allocs << " per call exceeds "
+                  << opts.maxAllocsPerCall << "\n";
+        reject = true;
+    }
+    if (opts.maxRssGrowthKb >= 0 && rss_growth > opts.maxRssGrowthKb) {
+        std::cerr << "Memory: RSS grew " << rss_growth << " KB, limit " << opts.maxRssGrowthKb << " KB\n";
+        reject = true;
+    }
+
+    std::cout << (reject ? "REJECT" : "PASS") << "\n";
+    return reject ? 2 : 0;
+}
+
+
+void usage(const char* prog)
+{
+    std::cerr << "Usage: " << prog << " <robot_file> [--profile N] [--board ROWS COLS] [--seed S]\n"
+              << "             [--max-p99-us US] [--max-allocs-per-call N] [--max-rss-growth-kb KB]\n";
+}
 
 int main(int argc, char* argv[]) 
 {
     //argv[1] should contain the name of the Robot_.cpp file to load.
 
-    if (argc != 2) 
+    if (argc < 2) 
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    bool           profiling = false;
+    ProfileOptions opts;
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--profile" && i + 1 < argc) {
+            profiling      = true;
+            opts.scenarios = std::atoi(argv[++i]);
+        } else if (arg == "--board" && i + 2 < argc) {
+            opts.rows = std::atoi(argv[++i]);
+            opts.cols = std::atoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            opts.seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--max-p99-us" && i + 1 < argc) {
+            opts.maxP99Us = std::atof(argv[++i]);
+        } else if (arg == "--max-allocs-per-call" && i + 1 < argc) {
+            opts.maxAllocsPerCall = std::atof(argv[++i]);
+        } else if (arg == "--max-rss-growth-kb" && i + 1 < argc) {
+            opts.maxRssGrowthKb = std::atol(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (opts.scenarios < 1 || opts.rows < 10 || opts.cols < 10)
     {
-        std::cerr << "Usage: " << argv[0] << " <robot_library>\n";
+        usage(argv[0]);
         return 1;
     }
 
@@ -169,8 +493,22 @@ int main(int argc, char* argv[])
     RobotBase *robot;
     void *handle;
 
-    robot = load_robot(shared_lib, handle);
-    test_robot_behavior(robot);
+    // dlopen only searches the library path for bare names, so point it here
+    robot = load_robot("./" + shared_lib, handle);
+    if (!robot)
+    {
+        return 1;
+    }
+
+    int status = 0;
+    if (profiling)
+    {
+        status = profile_robot(robot, opts);
+    }
+    else
+    {
+        test_robot_behavior(robot);
+    }
 
     // Cleanup
     delete robot;
@@ -178,5 +516,5 @@ int main(int argc, char* argv[])
 
     std::cout << "Robot testing complete.\n";
 
-    return 0;
+    return status;
 }